@@ -1,5 +1,8 @@
 #if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
-    #define _POSIX_C_SOURCE 200112L
+    #define _POSIX_C_SOURCE 200809L
+#endif
+#if !defined(_WIN32) && !defined(_GNU_SOURCE)
+    #define _GNU_SOURCE
 #endif
 
 #include "config.h"
@@ -12,21 +15,22 @@
 #include "include/aven/build/common.h"
 #include "include/aven/fs.h"
 #include "include/aven/str.h"
+#include "include/aven/str/intern.h"
 
 #include "build.h"
 
 #include <stdio.h>
-#include <stdlib.h>
 
-#define ARENA_SIZE (4096 * 2000)
+#define ARENA_RESERVE_SIZE ((size_t)1 << 30)
 
 int main(int argc, char **argv) {
-    void *mem = malloc(ARENA_SIZE);
-    if (mem == NULL) {
-        fprintf(stderr, "malloc failure\n");
+    AvenArenaVmResult arena_result = aven_arena_vm_init(ARENA_RESERVE_SIZE);
+    if (arena_result.error != 0) {
+        fprintf(stderr, "arena reserve failure\n");
+        return 1;
     }
 
-    AvenArena arena = aven_arena_init(mem, ARENA_SIZE);
+    AvenArena arena = arena_result.payload;
 
     int error = aven_arg_parse(
         aven_build_common_args,
@@ -51,6 +55,8 @@ int main(int argc, char **argv) {
         aven_build_common_args,
         &arena
     );
+    AvenStrInternTable intern = aven_str_intern_table_init(64, &arena);
+    opts.intern = &intern;
     AvenBuildStep libaven_step = libaven_build_step(
         &opts,
         aven_str("."),
@@ -79,15 +85,23 @@ int main(int argc, char **argv) {
         .ptr = test_obj_step_data,
         .len = countof(test_obj_step_data),
     };
+    AvenStrSlice test_libs = { 0 };
 #else
     AvenBuildStepPtrSlice test_obj_steps = { 0 };
+
+    // The atomic arena tests allocate from several threads
+    AvenStr test_lib_data[] = { aven_str("pthread") };
+    AvenStrSlice test_libs = {
+        .ptr = test_lib_data,
+        .len = countof(test_lib_data),
+    };
 #endif
 
     AvenBuildStep test_step = aven_build_common_step_cc_ld_run_exe_ex(
         &opts,
         (AvenStrSlice){ .ptr = &aven_include, .len = 1 },
         (AvenStrSlice){ 0 },
-        (AvenStrSlice){ 0 },
+        test_libs,
         test_obj_steps,
         aven_str("test.c"),
         &test_dir_step,
@@ -96,8 +110,29 @@ int main(int argc, char **argv) {
         &arena
     );
 
+    // Also link a test against the library object, so the attributes on
+    // the declarations are checked the way client code sees them
+    AvenBuildStep *fortify_obj_step_data[] = { &libaven_step };
+    AvenBuildStepPtrSlice fortify_obj_steps = {
+        .ptr = fortify_obj_step_data,
+        .len = countof(fortify_obj_step_data),
+    };
+    AvenBuildStep fortify_test_step = aven_build_common_step_cc_ld_run_exe_ex(
+        &opts,
+        (AvenStrSlice){ .ptr = &aven_include, .len = 1 },
+        (AvenStrSlice){ 0 },
+        (AvenStrSlice){ 0 },
+        fortify_obj_steps,
+        aven_str("test_fortify.c"),
+        &test_dir_step,
+        false,
+        (AvenStrSlice){ 0 },
+        &arena
+    );
+
     AvenBuildStep test_root_step = aven_build_step_root();
     aven_build_step_add_dep(&test_root_step, &test_step, &arena);
+    aven_build_step_add_dep(&test_root_step, &fortify_test_step, &arena);
 
     // Execute the chosen build step
 
@@ -116,6 +151,10 @@ int main(int argc, char **argv) {
         }
     }
 
+#ifdef AVEN_ARENA_STATS
+    aven_arena_stats_print();
+#endif
+
     return error;
 }
 
@@ -15,29 +15,163 @@
     #error "C99 or later is required"
 #endif
 
+// Allocations bump base up towards top, so the most recent allocation can be
+// resized in place. For virtual memory arenas committed is the end of the
+// committed region, pages are committed on demand as base moves up past it.
+// It is NULL for arenas backed by caller provided memory.
 typedef struct {
     unsigned char *base;
     unsigned char *top;
+    unsigned char *committed;
 } AvenArena;
 
 static inline AvenArena aven_arena_init(void *mem, size_t size) {
     return (AvenArena){ .base = mem, .top = (unsigned char *)mem + size };
 }
 
+// Allocations may be aligned to any power of two up to this, e.g. 64 for
+// cache lines or AVX-512 loads, or 4096 for pages
+#define AVEN_ARENA_MAX_ALIGN 4096
 
+#ifndef AVEN_ARENA_VM_COMMIT_SIZE
+    #define AVEN_ARENA_VM_COMMIT_SIZE (64 * 1024)
+#endif
+
+#ifndef AVEN_ARENA_VM_HUGE_PAGE_SIZE
+    #define AVEN_ARENA_VM_HUGE_PAGE_SIZE (2 * 1024 * 1024)
+#endif
+
+typedef Result(AvenArena) AvenArenaVmResult;
+typedef enum {
+    AVEN_ARENA_VM_ERROR_NONE = 0,
+    AVEN_ARENA_VM_ERROR_RESERVE,
+} AvenArenaVmError;
+
+// Reserves reserve_size bytes of address space without backing memory,
+// allocations never move and only touched pages count against memory use.
+// Allocation returns NULL if the system fails to commit more pages.
+AVEN_FN AvenArenaVmResult aven_arena_vm_init(size_t reserve_size);
+// Maps reserve_size bytes aligned to AVEN_ARENA_VM_HUGE_PAGE_SIZE and asks
+// the kernel to back them with transparent huge pages where supported, which
+// cuts TLB misses for large arenas. Pages are still only populated when
+// touched, but there is no per-chunk commit. Falls back to
+// aven_arena_vm_init on Windows, where large pages need special privileges.
+AVEN_FN AvenArenaVmResult aven_arena_vm_init_huge(size_t reserve_size);
+// Releases arenas from either init function
+AVEN_FN void aven_arena_vm_deinit(AvenArena arena, size_t reserve_size);
+
+// There is no alloc_size attribute since aven_arena_resize can grow the
+// allocation in place, past the size the compiler would assume, which trips
+// -Warray-bounds and _FORTIFY_SOURCE checks on valid code
 #if __has_attribute(malloc)
     __attribute__((malloc))
 #endif
 #if !defined(AVEN_ARENA_IMPLEMENTATION) and !defined(AVEN_HIMPLEMENTATION)
     // These attributes cause issues when compiling as one translation unit
-    #if __has_attribute(alloc_size)
-        __attribute__((alloc_size(2)))
-    #endif
     #if __has_attribute(alloc_align)
         __attribute__((alloc_align(3)))
     #endif
 #endif
-AVEN_FN void *aven_arena_alloc(AvenArena *arena, size_t size, size_t align);
+// Parenthesized so it is not expanded when AVEN_ARENA_STATS is defined
+AVEN_FN void *(aven_arena_alloc)(
+    AvenArena *arena,
+    size_t size,
+    size_t align
+);
+
+// Define AVEN_ARENA_STATS to record the allocation count, bytes, and alignment
+// padding for each aven_arena_alloc, aven_arena_realloc, and dyn_slice_push
+// call site, where growing in place counts the added bytes, and the
+// high-water mark of each arena (keyed by top, so copies of an arena share an
+// entry). Atomic allocations are not recorded and recording is not thread
+// safe.
+#ifdef AVEN_ARENA_STATS
+    #ifndef AVEN_ARENA_STATS_MAX_SITES
+        #define AVEN_ARENA_STATS_MAX_SITES 1024
+    #endif
+    #ifndef AVEN_ARENA_STATS_MAX_ARENAS
+        #define AVEN_ARENA_STATS_MAX_ARENAS 64
+    #endif
+
+    typedef struct {
+        const char *file;
+        int line;
+        size_t count;
+        size_t bytes;
+        size_t padding;
+    } AvenArenaStatsSite;
+
+    typedef struct {
+        unsigned char *top;
+        unsigned char *base_min;
+        unsigned char *base_max;
+    } AvenArenaStatsArena;
+
+    typedef struct {
+        AvenArenaStatsSite sites[AVEN_ARENA_STATS_MAX_SITES];
+        AvenArenaStatsArena arenas[AVEN_ARENA_STATS_MAX_ARENAS];
+        size_t nsites;
+        size_t narenas;
+        size_t dropped;
+    } AvenArenaStats;
+
+    AVEN_FN AvenArenaStats *aven_arena_stats(void);
+    AVEN_FN void *aven_arena_alloc_stats(
+        AvenArena *arena,
+        size_t size,
+        size_t align,
+        const char *file,
+        int line
+    );
+    AVEN_FN void *aven_arena_realloc_stats(
+        AvenArena *arena,
+        void *mem,
+        size_t old_size,
+        size_t new_size,
+        size_t align,
+        const char *file,
+        int line
+    );
+    AVEN_FN void *aven_arena_dyn_slice_grow_stats(
+        AvenArena *arena,
+        void *ptr,
+        size_t *cap,
+        size_t elem_size,
+        size_t elem_align,
+        const char *file,
+        int line
+    );
+    // Prints the call sites sorted by bytes allocated to stderr
+    AVEN_FN void aven_arena_stats_print(void);
+
+    #define aven_arena_alloc(arena, size, align) aven_arena_alloc_stats( \
+            arena, \
+            size, \
+            align, \
+            __FILE__, \
+            __LINE__ \
+        )
+    #define aven_arena_realloc(arena, mem, old_size, new_size, align) \
+        aven_arena_realloc_stats( \
+            arena, \
+            mem, \
+            old_size, \
+            new_size, \
+            align, \
+            __FILE__, \
+            __LINE__ \
+        )
+    #define aven_arena_dyn_slice_grow(arena, ptr, cap, elem_size, elem_align) \
+        aven_arena_dyn_slice_grow_stats( \
+            arena, \
+            ptr, \
+            cap, \
+            elem_size, \
+            elem_align, \
+            __FILE__, \
+            __LINE__ \
+        )
+#endif
 
 #define aven_arena_create(t, a) (t *)aven_arena_alloc( \
         a, \
@@ -50,25 +184,693 @@ AVEN_FN void *aven_arena_alloc(AvenArena *arena, size_t size, size_t align);
         aven_arena_alignof(t) \
     )
 
+// Resizes mem from old_size to new_size bytes without moving it, which only
+// succeeds if mem is the most recent allocation and the arena has room
+AVEN_FN bool aven_arena_resize(
+    AvenArena *arena,
+    void *mem,
+    size_t old_size,
+    size_t new_size
+);
+
+// Resizes in place if possible, otherwise allocates and copies
+AVEN_FN void *(aven_arena_realloc)(
+    AvenArena *arena,
+    void *mem,
+    size_t old_size,
+    size_t new_size,
+    size_t align
+);
+
+// A growable array, the ptr and len fields match Slice(t)
+#define DynSlice(t) struct { t *ptr; size_t len; size_t cap; }
+
+// Appends v to the DynSlice d of element type t, doubling its capacity with
+// aven_arena_realloc when full, which grows in place while d is the most
+// recent allocation
+#define dyn_slice_push(t, d, v, a) do { \
+        if ((d).len == (d).cap) { \
+            (d).ptr = aven_arena_dyn_slice_grow( \
+                a, \
+                (d).ptr, \
+                &(d).cap, \
+                sizeof(t), \
+                aven_arena_alignof(t) \
+            ); \
+        } \
+        (d).ptr[(d).len] = (v); \
+        (d).len += 1; \
+    } while (0)
+
+AVEN_FN void *(aven_arena_dyn_slice_grow)(
+    AvenArena *arena,
+    void *ptr,
+    size_t *cap,
+    size_t elem_size,
+    size_t elem_align
+);
+
+#if defined(__GNUC__) or defined(__clang__) or defined(_MSC_VER)
+    #define AVEN_ARENA_ATOMIC
+#endif
+
+#ifdef AVEN_ARENA_ATOMIC
+    // Safe to call concurrently on a shared arena, but must not be mixed with
+    // concurrent calls to the non-atomic functions on the same arena
+    #if __has_attribute(malloc)
+        __attribute__((malloc))
+    #endif
+    AVEN_FN void *aven_arena_alloc_atomic(
+        AvenArena *arena,
+        size_t size,
+        size_t align
+    );
+#endif
+
+// Carves a fixed size sub-arena out of the arena, e.g. so each thread can
+// bump allocate locally and only touch the shared arena once per chunk
+AVEN_FN AvenArena aven_arena_sub(AvenArena *arena, size_t size);
+#ifdef AVEN_ARENA_ATOMIC
+    AVEN_FN AvenArena aven_arena_sub_atomic(AvenArena *arena, size_t size);
+#endif
+
 #ifdef AVEN_IMPLEMENTATION
 
-AVEN_FN void *aven_arena_alloc(AvenArena *arena, size_t size, size_t align) {
-    assert(
-        align == 1 ||
-        align == 2 ||
-        align == 4 ||
-        align == 8 ||
-        align == 16 ||
-        align == 32
+#ifndef _WIN32
+    #include <sys/mman.h>
+    #include <unistd.h>
+
+    #if !defined(MAP_ANONYMOUS) and !defined(MAP_ANON)
+        #error "aven_arena_vm requires MAP_ANONYMOUS, e.g. _DEFAULT_SOURCE"
+    #endif
+#endif
+
+#include <string.h>
+
+#ifdef AVEN_ARENA_STATS
+    #include <stdio.h>
+#endif
+
+static inline bool aven_arena_align_valid(size_t align) {
+    return align != 0 and
+        (align & (align - 1)) == 0 and
+        align <= AVEN_ARENA_MAX_ALIGN;
+}
+
+static size_t aven_arena_vm_page_size(void) {
+#ifdef _WIN32
+    return 64 * 1024;
+#else
+    long page_size = sysconf(_SC_PAGESIZE);
+    assert(page_size > 0);
+    return (size_t)page_size;
+#endif
+}
+
+#ifndef _WIN32
+    // Maps size bytes of private zeroed memory, or returns NULL
+    static void *aven_arena_vm_map(size_t size, int prot) {
+    #ifndef MAP_ANONYMOUS
+        #define MAP_ANONYMOUS MAP_ANON
+    #endif
+    #ifndef MAP_NORESERVE
+        #define MAP_NORESERVE 0
+    #endif
+        void *mem = mmap(
+            NULL,
+            size,
+            prot,
+            MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE,
+            -1,
+            0
+        );
+        if (mem == MAP_FAILED) {
+            return NULL;
+        }
+        return mem;
+    }
+#endif
+
+AVEN_FN AvenArenaVmResult aven_arena_vm_init(size_t reserve_size) {
+    size_t page_size = aven_arena_vm_page_size();
+    reserve_size = (reserve_size + page_size - 1) & ~(page_size - 1);
+
+#ifdef _WIN32
+    AVEN_WIN32_FN(void *) VirtualAlloc(
+        void *addr,
+        size_t size,
+        unsigned long type,
+        unsigned long protect
     );
-    unsigned char *mem = arena->top - size;
-    size_t padding = (size_t)((uintptr_t)mem & (align - 1));
+
+    void *mem = VirtualAlloc(
+        NULL,
+        reserve_size,
+        0x00002000, /* MEM_RESERVE */
+        0x01 /* PAGE_NOACCESS */
+    );
+    if (mem == NULL) {
+        return (AvenArenaVmResult){ .error = AVEN_ARENA_VM_ERROR_RESERVE };
+    }
+#else
+    void *mem = aven_arena_vm_map(reserve_size, PROT_NONE);
+    if (mem == NULL) {
+        return (AvenArenaVmResult){ .error = AVEN_ARENA_VM_ERROR_RESERVE };
+    }
+#endif
+
+    unsigned char *top = (unsigned char *)mem + reserve_size;
+    return (AvenArenaVmResult){
+        .payload = { .base = mem, .top = top, .committed = mem },
+    };
+}
+
+AVEN_FN AvenArenaVmResult aven_arena_vm_init_huge(size_t reserve_size) {
+#ifdef _WIN32
+    return aven_arena_vm_init(reserve_size);
+#else
+    size_t page_size = aven_arena_vm_page_size();
+    reserve_size = (reserve_size + page_size - 1) & ~(page_size - 1);
+
+    // Over-map by a huge page and trim both ends so the arena starts on a
+    // huge page boundary, otherwise the kernel can only use huge pages for
+    // the aligned middle of the region
+    size_t huge_size = AVEN_ARENA_VM_HUGE_PAGE_SIZE;
+    size_t map_size = reserve_size + huge_size;
+    unsigned char *map = aven_arena_vm_map(
+        map_size,
+        PROT_READ | PROT_WRITE
+    );
+    if (map == NULL) {
+        return (AvenArenaVmResult){ .error = AVEN_ARENA_VM_ERROR_RESERVE };
+    }
+
+    uintptr_t mask = (uintptr_t)(huge_size - 1);
+    unsigned char *mem = (unsigned char *)(((uintptr_t)map + mask) & ~mask);
+    unsigned char *top = mem + reserve_size;
+    if (mem > map) {
+        munmap(map, (size_t)(mem - map));
+    }
+    if (top < map + map_size) {
+        munmap(top, (size_t)(map + map_size - top));
+    }
+
+    // Advisory only, e.g. it fails if transparent huge pages are disabled.
+    // MADV_HUGEPAGE is Linux specific and glibc needs _DEFAULT_SOURCE for
+    // it, without it the advice is skipped and the aligned mapping only gets
+    // huge pages when the kernel uses them for all anonymous memory.
+    #ifdef MADV_HUGEPAGE
+        madvise(mem, reserve_size, MADV_HUGEPAGE);
+    #endif
+
+    // Memory is readable and writable up front, so there is nothing to commit
+    return (AvenArenaVmResult){
+        .payload = { .base = mem, .top = top },
+    };
+#endif
+}
+
+AVEN_FN void aven_arena_vm_deinit(AvenArena arena, size_t reserve_size) {
+    size_t page_size = aven_arena_vm_page_size();
+    reserve_size = (reserve_size + page_size - 1) & ~(page_size - 1);
+    unsigned char *mem = arena.top - reserve_size;
+
+#ifdef _WIN32
+    AVEN_WIN32_FN(int) VirtualFree(
+        void *addr,
+        size_t size,
+        unsigned long type
+    );
+
+    VirtualFree(mem, 0, 0x00008000 /* MEM_RELEASE */);
+#else
+    munmap(mem, reserve_size);
+#endif
+}
+
+// Commits pages so that [committed, end) is usable, in chunks of
+// AVEN_ARENA_VM_COMMIT_SIZE to amortize the system calls, and returns the new
+// end of the committed region, or NULL if the pages could not be committed
+static unsigned char *aven_arena_vm_commit(
+    unsigned char *top,
+    unsigned char *end,
+    unsigned char *committed
+) {
+    uintptr_t mask = (uintptr_t)(AVEN_ARENA_VM_COMMIT_SIZE - 1);
+    uintptr_t high = ((uintptr_t)end + mask) & ~mask;
+    unsigned char *new_committed = (unsigned char *)high;
+    if (high > (uintptr_t)top) {
+        new_committed = top;
+    }
+    size_t size = (size_t)(new_committed - committed);
+
+#ifdef _WIN32
+    AVEN_WIN32_FN(void *) VirtualAlloc(
+        void *addr,
+        size_t size,
+        unsigned long type,
+        unsigned long protect
+    );
+
+    void *result = VirtualAlloc(
+        committed,
+        size,
+        0x00001000, /* MEM_COMMIT */
+        0x04 /* PAGE_READWRITE */
+    );
+    if (result == NULL) {
+        return NULL;
+    }
+#else
+    if (mprotect(committed, size, PROT_READ | PROT_WRITE) != 0) {
+        return NULL;
+    }
+#endif
+
+    return new_committed;
+}
+
+AVEN_FN void *(aven_arena_alloc)(
+    AvenArena *arena,
+    size_t size,
+    size_t align
+) {
+    assert(aven_arena_align_valid(align));
+    size_t padding = (size_t)(-(uintptr_t)arena->base & (align - 1));
     assert((arena->top - arena->base) >= (ptrdiff_t)(size + padding));
 
-    arena->top = mem - padding;
-    return arena->top;
+    unsigned char *mem = arena->base + padding;
+    unsigned char *end = mem + size;
+    if (arena->committed != NULL and end > arena->committed) {
+        unsigned char *committed = aven_arena_vm_commit(
+            arena->top,
+            end,
+            arena->committed
+        );
+        // Out of memory like an exhausted arena, but the system decides
+        assert(committed != NULL);
+        if (committed == NULL) {
+            return NULL;
+        }
+        arena->committed = committed;
+    }
+    arena->base = end;
+    return mem;
+}
+
+#ifdef AVEN_ARENA_ATOMIC
+    #if defined(__GNUC__) or defined(__clang__)
+        static inline unsigned char *aven_arena_atomic_load(
+            unsigned char **ptr
+        ) {
+            return __atomic_load_n(ptr, __ATOMIC_ACQUIRE);
+        }
+
+        static inline bool aven_arena_atomic_cas(
+            unsigned char **ptr,
+            unsigned char **expected,
+            unsigned char *desired
+        ) {
+            return __atomic_compare_exchange_n(
+                ptr,
+                expected,
+                desired,
+                true,
+                __ATOMIC_ACQ_REL,
+                __ATOMIC_ACQUIRE
+            );
+        }
+    #else
+        void *_InterlockedCompareExchangePointer(
+            void *volatile *dest,
+            void *exchange,
+            void *comparand
+        );
+        #pragma intrinsic(_InterlockedCompareExchangePointer)
+
+        // Volatile accesses have acquire/release semantics on MSVC
+        static inline unsigned char *aven_arena_atomic_load(
+            unsigned char **ptr
+        ) {
+            return *(unsigned char *volatile *)ptr;
+        }
+
+        static inline bool aven_arena_atomic_cas(
+            unsigned char **ptr,
+            unsigned char **expected,
+            unsigned char *desired
+        ) {
+            unsigned char *prev = _InterlockedCompareExchangePointer(
+                (void *volatile *)ptr,
+                desired,
+                *expected
+            );
+            if (prev == *expected) {
+                return true;
+            }
+            *expected = prev;
+            return false;
+        }
+    #endif
+
+    AVEN_FN void *aven_arena_alloc_atomic(
+        AvenArena *arena,
+        size_t size,
+        size_t align
+    ) {
+        assert(aven_arena_align_valid(align));
+
+        unsigned char *base = aven_arena_atomic_load(&arena->base);
+        unsigned char *mem;
+        do {
+            size_t padding = (size_t)(-(uintptr_t)base & (align - 1));
+            assert((arena->top - base) >= (ptrdiff_t)(size + padding));
+            mem = base + padding;
+        } while (!aven_arena_atomic_cas(&arena->base, &base, mem + size));
+
+        // Racing threads may commit overlapping ranges, which is harmless,
+        // and committed only moves up once the pages below it are usable
+        unsigned char *end = mem + size;
+        unsigned char *committed = aven_arena_atomic_load(&arena->committed);
+        if (committed != NULL and end > committed) {
+            unsigned char *new_committed = aven_arena_vm_commit(
+                arena->top,
+                end,
+                committed
+            );
+            // The range stays claimed, but nothing is handed out in it
+            assert(new_committed != NULL);
+            if (new_committed == NULL) {
+                return NULL;
+            }
+            while (
+                new_committed > committed and
+                !aven_arena_atomic_cas(
+                    &arena->committed,
+                    &committed,
+                    new_committed
+                )
+            ) {}
+        }
+
+        return mem;
+    }
+
+    AVEN_FN AvenArena aven_arena_sub_atomic(AvenArena *arena, size_t size) {
+        unsigned char *mem = aven_arena_alloc_atomic(arena, size, 32);
+        return aven_arena_init(mem, size);
+    }
+#endif
+
+AVEN_FN AvenArena aven_arena_sub(AvenArena *arena, size_t size) {
+    unsigned char *mem = aven_arena_alloc(arena, size, 32);
+    return aven_arena_init(mem, size);
+}
+
+AVEN_FN bool aven_arena_resize(
+    AvenArena *arena,
+    void *mem,
+    size_t old_size,
+    size_t new_size
+) {
+    unsigned char *start = mem;
+    if (start + old_size != arena->base) {
+        return new_size <= old_size;
+    }
+    if ((size_t)(arena->top - start) < new_size) {
+        return false;
+    }
+
+    unsigned char *end = start + new_size;
+    if (arena->committed != NULL and end > arena->committed) {
+        unsigned char *committed = aven_arena_vm_commit(
+            arena->top,
+            end,
+            arena->committed
+        );
+        if (committed == NULL) {
+            return false;
+        }
+        arena->committed = committed;
+    }
+    arena->base = end;
+    return true;
 }
 
+AVEN_FN void *(aven_arena_realloc)(
+    AvenArena *arena,
+    void *mem,
+    size_t old_size,
+    size_t new_size,
+    size_t align
+) {
+    if (mem != NULL and aven_arena_resize(arena, mem, old_size, new_size)) {
+        return mem;
+    }
+
+    void *new_mem = (aven_arena_alloc)(arena, new_size, align);
+    if (mem != NULL) {
+        memcpy(new_mem, mem, min(old_size, new_size));
+    }
+    return new_mem;
+}
+
+AVEN_FN void *(aven_arena_dyn_slice_grow)(
+    AvenArena *arena,
+    void *ptr,
+    size_t *cap,
+    size_t elem_size,
+    size_t elem_align
+) {
+    size_t new_cap = max(2 * *cap, (size_t)8);
+    void *new_ptr = (aven_arena_realloc)(
+        arena,
+        ptr,
+        *cap * elem_size,
+        new_cap * elem_size,
+        elem_align
+    );
+    *cap = new_cap;
+    return new_ptr;
+}
+
+#ifdef AVEN_ARENA_STATS
+    AVEN_FN AvenArenaStats *aven_arena_stats(void) {
+        static AvenArenaStats stats;
+        return &stats;
+    }
+
+    static AvenArenaStatsSite *aven_arena_stats_site(
+        AvenArenaStats *stats,
+        const char *file,
+        int line
+    ) {
+        uintptr_t hash = ((uintptr_t)file >> 3) ^
+            ((uintptr_t)line * 0x9e3779b1U);
+        for (size_t i = 0; i < AVEN_ARENA_STATS_MAX_SITES; i += 1) {
+            size_t index = (size_t)(hash + i) % AVEN_ARENA_STATS_MAX_SITES;
+            AvenArenaStatsSite *site = &stats->sites[index];
+            if (site->file == NULL) {
+                if (stats->nsites + 1 == AVEN_ARENA_STATS_MAX_SITES) {
+                    return NULL;
+                }
+                site->file = file;
+                site->line = line;
+                stats->nsites += 1;
+                return site;
+            }
+            if (site->file == file and site->line == line) {
+                return site;
+            }
+        }
+        return NULL;
+    }
+
+    static AvenArenaStatsArena *aven_arena_stats_arena(
+        AvenArenaStats *stats,
+        unsigned char *top
+    ) {
+        for (size_t i = 0; i < stats->narenas; i += 1) {
+            if (stats->arenas[i].top == top) {
+                return &stats->arenas[i];
+            }
+        }
+        if (stats->narenas == AVEN_ARENA_STATS_MAX_ARENAS) {
+            return NULL;
+        }
+        AvenArenaStatsArena *entry = &stats->arenas[stats->narenas];
+        stats->narenas += 1;
+        *entry = (AvenArenaStatsArena){ .top = top };
+        return entry;
+    }
+
+    // Records size bytes placed at mem, where base was the arena base before
+    static void aven_arena_stats_record(
+        AvenArena *arena,
+        unsigned char *base,
+        unsigned char *mem,
+        size_t size,
+        const char *file,
+        int line
+    ) {
+        AvenArenaStats *stats = aven_arena_stats();
+        AvenArenaStatsSite *site = aven_arena_stats_site(stats, file, line);
+        AvenArenaStatsArena *entry = aven_arena_stats_arena(
+            stats,
+            arena->top
+        );
+        if (site == NULL or entry == NULL) {
+            stats->dropped += 1;
+            return;
+        }
+
+        site->count += 1;
+        site->bytes += size;
+        site->padding += (size_t)(mem - base);
+
+        if (entry->base_min == NULL or base < entry->base_min) {
+            entry->base_min = base;
+        }
+        if (entry->base_max == NULL or arena->base > entry->base_max) {
+            entry->base_max = arena->base;
+        }
+    }
+
+    AVEN_FN void *aven_arena_alloc_stats(
+        AvenArena *arena,
+        size_t size,
+        size_t align,
+        const char *file,
+        int line
+    ) {
+        unsigned char *base = arena->base;
+        unsigned char *mem = (aven_arena_alloc)(arena, size, align);
+        aven_arena_stats_record(arena, base, mem, size, file, line);
+        return mem;
+    }
+
+    AVEN_FN void *aven_arena_realloc_stats(
+        AvenArena *arena,
+        void *mem,
+        size_t old_size,
+        size_t new_size,
+        size_t align,
+        const char *file,
+        int line
+    ) {
+        unsigned char *base = arena->base;
+        if (mem != NULL and aven_arena_resize(arena, mem, old_size, new_size)) {
+            // Growing in place charges the call site only the added bytes
+            if (new_size > old_size) {
+                aven_arena_stats_record(
+                    arena,
+                    base,
+                    base,
+                    new_size - old_size,
+                    file,
+                    line
+                );
+            }
+            return mem;
+        }
+
+        void *new_mem = aven_arena_alloc_stats(
+            arena,
+            new_size,
+            align,
+            file,
+            line
+        );
+        if (mem != NULL) {
+            memcpy(new_mem, mem, min(old_size, new_size));
+        }
+        return new_mem;
+    }
+
+    AVEN_FN void *aven_arena_dyn_slice_grow_stats(
+        AvenArena *arena,
+        void *ptr,
+        size_t *cap,
+        size_t elem_size,
+        size_t elem_align,
+        const char *file,
+        int line
+    ) {
+        size_t new_cap = max(2 * *cap, (size_t)8);
+        void *new_ptr = aven_arena_realloc_stats(
+            arena,
+            ptr,
+            *cap * elem_size,
+            new_cap * elem_size,
+            elem_align,
+            file,
+            line
+        );
+        *cap = new_cap;
+        return new_ptr;
+    }
+
+    AVEN_FN void aven_arena_stats_print(void) {
+        AvenArenaStats *stats = aven_arena_stats();
+
+        AvenArenaStatsSite *sorted[AVEN_ARENA_STATS_MAX_SITES];
+        size_t len = 0;
+        for (size_t i = 0; i < AVEN_ARENA_STATS_MAX_SITES; i += 1) {
+            AvenArenaStatsSite *site = &stats->sites[i];
+            if (site->file == NULL) {
+                continue;
+            }
+
+            size_t j = len;
+            while (j > 0 and sorted[j - 1]->bytes < site->bytes) {
+                sorted[j] = sorted[j - 1];
+                j -= 1;
+            }
+            sorted[j] = site;
+            len += 1;
+        }
+
+        fprintf(stderr, "arena high-water marks:\n");
+        for (size_t i = 0; i < stats->narenas; i += 1) {
+            AvenArenaStatsArena *entry = &stats->arenas[i];
+            fprintf(
+                stderr,
+                "  %p: %zu bytes\n",
+                (void *)entry->top,
+                (size_t)(entry->base_max - entry->base_min)
+            );
+        }
+
+        fprintf(stderr, "arena allocations by call site:\n");
+        fprintf(
+            stderr,
+            "  %12s %12s %10s  %s\n",
+            "bytes",
+            "count",
+            "padding",
+            "site"
+        );
+        for (size_t i = 0; i < len; i += 1) {
+            fprintf(
+                stderr,
+                "  %12zu %12zu %10zu  %s:%d\n",
+                sorted[i]->bytes,
+                sorted[i]->count,
+                sorted[i]->padding,
+                sorted[i]->file,
+                sorted[i]->line
+            );
+        }
+        if (stats->dropped > 0) {
+            fprintf(
+                stderr,
+                "  %zu allocations not recorded (tables full)\n",
+                stats->dropped
+            );
+        }
+    }
+#endif
+
 #endif // AVEN_IMPLEMENTATION
 
 #endif // AVEN_ARENA_H
@@ -0,0 +1,139 @@
+#ifndef AVEN_ARENA_ALLOCATOR_H
+#define AVEN_ARENA_ALLOCATOR_H
+
+#include "../../aven.h"
+#include "../arena.h"
+
+// Alignment of every block, matching what malloc guarantees
+#ifndef AVEN_ARENA_ALLOCATOR_ALIGN
+    #define AVEN_ARENA_ALLOCATOR_ALIGN 16
+#endif
+
+// A malloc, realloc, and free compatible interface for third party code.
+// The functions take ctx as their first argument, which is usually all it
+// takes to wrap them in the callbacks a library expects. Allocation returns
+// NULL when the arena is full. Blocks carry a size header so realloc knows
+// how much to copy, and free and realloc work in place on the most recent
+// block; freeing any other block is a no-op until the arena is reset.
+typedef struct {
+    void *(*alloc)(void *ctx, size_t size);
+    void *(*realloc)(void *ctx, void *mem, size_t size);
+    void (*free)(void *ctx, void *mem);
+    void *ctx;
+} AvenArenaAllocator;
+
+// The arena must outlive the allocator, and everything allocated through it
+// is released at once by resetting the arena, e.g. restoring a saved copy
+AVEN_FN AvenArenaAllocator aven_arena_allocator(AvenArena *arena);
+
+AVEN_FN void *aven_arena_allocator_alloc(void *ctx, size_t size);
+AVEN_FN void *aven_arena_allocator_realloc(void *ctx, void *mem, size_t size);
+AVEN_FN void aven_arena_allocator_free(void *ctx, void *mem);
+
+#ifdef AVEN_IMPLEMENTATION
+
+#include <string.h>
+
+static inline size_t *aven_arena_allocator_header(void *mem) {
+    return (size_t *)mem - 1;
+}
+
+// Blocks are padded to the alignment so consecutive blocks are contiguous
+// and the most recent one always ends at the arena base
+static inline size_t aven_arena_allocator_round(size_t size) {
+    size_t mask = AVEN_ARENA_ALLOCATOR_ALIGN - 1;
+    return (size + mask) & ~mask;
+}
+
+AVEN_FN AvenArenaAllocator aven_arena_allocator(AvenArena *arena) {
+    return (AvenArenaAllocator){
+        .alloc = aven_arena_allocator_alloc,
+        .realloc = aven_arena_allocator_realloc,
+        .free = aven_arena_allocator_free,
+        .ctx = arena,
+    };
+}
+
+// Sizes this large would wrap around when rounded up and given a header
+static inline bool aven_arena_allocator_size_valid(size_t size) {
+    return size <= SIZE_MAX - 2 * AVEN_ARENA_ALLOCATOR_ALIGN;
+}
+
+AVEN_FN void *aven_arena_allocator_alloc(void *ctx, size_t size) {
+    AvenArena *arena = ctx;
+    if (!aven_arena_allocator_size_valid(size)) {
+        return NULL;
+    }
+
+    // The block is the alignment padding, the header, and the rounded size
+    size_t header = AVEN_ARENA_ALLOCATOR_ALIGN;
+    size_t block_size = header + aven_arena_allocator_round(size);
+    size_t padding = (size_t)(
+        -(uintptr_t)arena->base & (AVEN_ARENA_ALLOCATOR_ALIGN - 1)
+    );
+    size_t available = (size_t)(arena->top - arena->base);
+    if (available < padding or block_size > available - padding) {
+        return NULL;
+    }
+
+    unsigned char *mem = aven_arena_alloc(
+        arena,
+        block_size,
+        AVEN_ARENA_ALLOCATOR_ALIGN
+    );
+    mem += header;
+    *aven_arena_allocator_header(mem) = size;
+    return mem;
+}
+
+AVEN_FN void aven_arena_allocator_free(void *ctx, void *mem) {
+    AvenArena *arena = ctx;
+    if (mem == NULL) {
+        return;
+    }
+
+    unsigned char *start = mem;
+    size_t size = aven_arena_allocator_round(
+        *aven_arena_allocator_header(mem)
+    );
+    if (start + size == arena->base) {
+        arena->base = start - AVEN_ARENA_ALLOCATOR_ALIGN;
+    }
+}
+
+AVEN_FN void *aven_arena_allocator_realloc(
+    void *ctx,
+    void *mem,
+    size_t size
+) {
+    AvenArena *arena = ctx;
+    if (mem == NULL) {
+        return aven_arena_allocator_alloc(ctx, size);
+    }
+
+    size_t old_size = *aven_arena_allocator_header(mem);
+    if (!aven_arena_allocator_size_valid(size)) {
+        return NULL;
+    }
+    if (
+        aven_arena_resize(
+            arena,
+            mem,
+            aven_arena_allocator_round(old_size),
+            aven_arena_allocator_round(size)
+        )
+    ) {
+        *aven_arena_allocator_header(mem) = size;
+        return mem;
+    }
+
+    void *new_mem = aven_arena_allocator_alloc(ctx, size);
+    if (new_mem != NULL) {
+        memcpy(new_mem, mem, min(old_size, size));
+    }
+    return new_mem;
+}
+
+#endif // AVEN_IMPLEMENTATION
+
+#endif // AVEN_ARENA_ALLOCATOR_H
@@ -0,0 +1,229 @@
+#ifndef AVEN_ARENA_POOL_H
+#define AVEN_ARENA_POOL_H
+
+#include "../../aven.h"
+#include "../arena.h"
+
+// Number of slots carved from the backing arena at a time
+#ifndef AVEN_ARENA_POOL_CHUNK_LEN
+    #define AVEN_ARENA_POOL_CHUNK_LEN 64
+#endif
+
+// A pool of fixed size slots carved from an arena in chunks. Freed slots are
+// kept on an intrusive free list (the first word of a free slot points to the
+// next one) and reused before carving more, so repeated alloc/free cycles run
+// in memory bounded by the peak number of live slots.
+typedef struct {
+    unsigned char *free;
+    AvenArena chunk;
+    size_t size;
+    size_t align;
+} AvenArenaPool;
+
+AVEN_FN AvenArenaPool aven_arena_pool_init(size_t size, size_t align);
+AVEN_FN void *aven_arena_pool_alloc(AvenArenaPool *pool, AvenArena *arena);
+AVEN_FN void aven_arena_pool_free(AvenArenaPool *pool, void *mem);
+
+#define aven_arena_pool_init_type(t) aven_arena_pool_init( \
+        sizeof(t), \
+        aven_arena_alignof(t) \
+    )
+#define aven_arena_pool_create(t, p, a) (t *)aven_arena_pool_alloc(p, a)
+
+#ifdef AVEN_ARENA_ATOMIC
+    // A per-thread cache in front of a shared pool. Allocation and free only
+    // touch the cache and run in constant time. Slots freed through the cache
+    // collect on a counted spill list whose tail is tracked, so once it holds
+    // a chunk worth of slots the whole batch is pushed back in one atomic
+    // swap. When both lists are empty the cache takes the whole shared free
+    // list in one swap, without walking it. New chunks are carved with
+    // aven_arena_sub_atomic, so the backing arena may be shared too. The pool
+    // must not also be used directly through aven_arena_pool_alloc or
+    // aven_arena_pool_free at the same time.
+    typedef struct {
+        AvenArenaPool *pool;
+        unsigned char *free;
+        unsigned char *spill;
+        unsigned char *spill_last;
+        size_t spill_len;
+        AvenArena chunk;
+    } AvenArenaPoolCache;
+
+    AVEN_FN AvenArenaPoolCache aven_arena_pool_cache_init(AvenArenaPool *pool);
+    AVEN_FN void *aven_arena_pool_cache_alloc(
+        AvenArenaPoolCache *cache,
+        AvenArena *arena
+    );
+    AVEN_FN void aven_arena_pool_cache_free(
+        AvenArenaPoolCache *cache,
+        void *mem
+    );
+    // Returns all cached free slots to the pool, e.g. before a thread exits,
+    // this walks the slots taken in the last refill to find their tail
+    AVEN_FN void aven_arena_pool_cache_flush(AvenArenaPoolCache *cache);
+#endif
+
+#ifdef AVEN_IMPLEMENTATION
+
+static inline unsigned char *aven_arena_pool_next(unsigned char *slot) {
+    return *(unsigned char **)slot;
+}
+
+static inline void aven_arena_pool_set_next(
+    unsigned char *slot,
+    unsigned char *next
+) {
+    *(unsigned char **)slot = next;
+}
+
+AVEN_FN AvenArenaPool aven_arena_pool_init(size_t size, size_t align) {
+    // Free slots must be able to hold the link to the next one
+    align = max(align, aven_arena_alignof(unsigned char *));
+    size = max(size, sizeof(unsigned char *));
+    size = (size + align - 1) & ~(align - 1);
+
+    return (AvenArenaPool){ .size = size, .align = align };
+}
+
+static void *aven_arena_pool_carve(
+    AvenArenaPool *pool,
+    AvenArena *chunk,
+    AvenArena *arena,
+    bool atomic
+) {
+    size_t padding = (size_t)(-(uintptr_t)chunk->base & (pool->align - 1));
+    if ((size_t)(chunk->top - chunk->base) < pool->size + padding) {
+        size_t chunk_size = AVEN_ARENA_POOL_CHUNK_LEN * pool->size +
+            pool->align;
+#ifdef AVEN_ARENA_ATOMIC
+        if (atomic) {
+            *chunk = aven_arena_sub_atomic(arena, chunk_size);
+        } else {
+            *chunk = aven_arena_sub(arena, chunk_size);
+        }
+#else
+        (void)atomic;
+        *chunk = aven_arena_sub(arena, chunk_size);
+#endif
+    }
+
+    return aven_arena_alloc(chunk, pool->size, pool->align);
+}
+
+AVEN_FN void *aven_arena_pool_alloc(AvenArenaPool *pool, AvenArena *arena) {
+    if (pool->free != NULL) {
+        unsigned char *slot = pool->free;
+        pool->free = aven_arena_pool_next(slot);
+        return slot;
+    }
+
+    return aven_arena_pool_carve(pool, &pool->chunk, arena, false);
+}
+
+AVEN_FN void aven_arena_pool_free(AvenArenaPool *pool, void *mem) {
+    aven_arena_pool_set_next(mem, pool->free);
+    pool->free = mem;
+}
+
+#ifdef AVEN_ARENA_ATOMIC
+    AVEN_FN AvenArenaPoolCache aven_arena_pool_cache_init(AvenArenaPool *pool) {
+        return (AvenArenaPoolCache){ .pool = pool };
+    }
+
+    // Pushes the list [first, last] onto the shared free list, pushing is
+    // safe from ABA since it never reads the next link of the shared head
+    static void aven_arena_pool_push_shared(
+        AvenArenaPool *pool,
+        unsigned char *first,
+        unsigned char *last
+    ) {
+        unsigned char *head = aven_arena_atomic_load(&pool->free);
+        do {
+            aven_arena_pool_set_next(last, head);
+        } while (!aven_arena_atomic_cas(&pool->free, &head, first));
+    }
+
+    AVEN_FN void *aven_arena_pool_cache_alloc(
+        AvenArenaPoolCache *cache,
+        AvenArena *arena
+    ) {
+        if (cache->spill != NULL) {
+            unsigned char *slot = cache->spill;
+            cache->spill = aven_arena_pool_next(slot);
+            cache->spill_len -= 1;
+            if (cache->spill == NULL) {
+                cache->spill_last = NULL;
+            }
+            return slot;
+        }
+
+        if (cache->free == NULL) {
+            // Taking the entire list is safe from ABA, unlike popping one
+            unsigned char *head = aven_arena_atomic_load(&cache->pool->free);
+            while (
+                head != NULL and
+                !aven_arena_atomic_cas(&cache->pool->free, &head, NULL)
+            ) {}
+            cache->free = head;
+        }
+
+        if (cache->free != NULL) {
+            unsigned char *slot = cache->free;
+            cache->free = aven_arena_pool_next(slot);
+            return slot;
+        }
+
+        return aven_arena_pool_carve(cache->pool, &cache->chunk, arena, true);
+    }
+
+    AVEN_FN void aven_arena_pool_cache_free(
+        AvenArenaPoolCache *cache,
+        void *mem
+    ) {
+        aven_arena_pool_set_next(mem, cache->spill);
+        if (cache->spill == NULL) {
+            cache->spill_last = mem;
+        }
+        cache->spill = mem;
+        cache->spill_len += 1;
+
+        if (cache->spill_len < AVEN_ARENA_POOL_CHUNK_LEN) {
+            return;
+        }
+
+        aven_arena_pool_push_shared(
+            cache->pool,
+            cache->spill,
+            cache->spill_last
+        );
+        cache->spill = NULL;
+        cache->spill_last = NULL;
+        cache->spill_len = 0;
+    }
+
+    AVEN_FN void aven_arena_pool_cache_flush(AvenArenaPoolCache *cache) {
+        if (cache->spill != NULL) {
+            aven_arena_pool_push_shared(
+                cache->pool,
+                cache->spill,
+                cache->spill_last
+            );
+            cache->spill = NULL;
+            cache->spill_last = NULL;
+            cache->spill_len = 0;
+        }
+
+        if (cache->free != NULL) {
+            unsigned char *last = cache->free;
+            while (aven_arena_pool_next(last) != NULL) {
+                last = aven_arena_pool_next(last);
+            }
+            aven_arena_pool_push_shared(cache->pool, cache->free, last);
+            cache->free = NULL;
+        }
+    }
+#endif
+
+#endif // AVEN_IMPLEMENTATION
+
+#endif // AVEN_ARENA_POOL_H
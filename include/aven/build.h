@@ -3,6 +3,7 @@
 
 #include "../aven.h"
 #include "arena.h"
+#include "arena/pool.h"
 #include "proc.h"
 #include "str.h"
 
@@ -130,6 +131,41 @@ static inline void aven_build_step_add_dep(
     step->dep = node;
 }
 
+// Like aven_build_step_add_dep, but takes the node from a pool created with
+// aven_arena_pool_init_type(AvenBuildStepNode), so graphs that are torn down
+// with aven_build_step_remove_deps and rebuilt reuse the same memory
+static inline void aven_build_step_add_dep_pool(
+    AvenBuildStep *step,
+    AvenBuildStep *dep,
+    AvenArenaPool *pool,
+    AvenArena *arena
+) {
+    AvenBuildStepNode *node = aven_arena_pool_create(
+        AvenBuildStepNode,
+        pool,
+        arena
+    );
+    *node = (AvenBuildStepNode){
+        .next = step->dep,
+        .step = dep,
+    };
+    step->dep = node;
+}
+
+// Unlinks the dependencies of step and returns their nodes to the pool
+static inline void aven_build_step_remove_deps(
+    AvenBuildStep *step,
+    AvenArenaPool *pool
+) {
+    AvenBuildStepNode *dep = step->dep;
+    while (dep != NULL) {
+        AvenBuildStepNode *next = dep->next;
+        aven_arena_pool_free(pool, dep);
+        dep = next;
+    }
+    step->dep = NULL;
+}
+
 typedef enum {
     AVEN_BUILD_STEP_RUN_ERROR_NONE = 0,
     AVEN_BUILD_STEP_RUN_ERROR_DEPRUN,
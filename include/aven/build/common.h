@@ -7,6 +7,7 @@
 #include "../build.h"
 #include "../path.h"
 #include "../str.h"
+#include "../str/intern.h"
 
 typedef struct {
     AvenStr compiler;
@@ -53,6 +54,10 @@ typedef struct {
     AvenStrSlice wrexts;
     bool clean;
     bool test;
+    // When set, flag arguments repeated across steps (e.g. include and macro
+    // flags) share a single interned copy. The table must be allocated from
+    // the same arena that is passed to the step functions.
+    AvenStrInternTable *intern;
 } AvenBuildCommonOpts;
 
 static char aven_build_common_overview_cstr[] = "Aven C build system";
@@ -577,6 +582,7 @@ static inline AvenBuildCommonOpts aven_build_common_opts(
     opts.cc.objflag = aven_str_cstr(aven_arg_get_str(arg_slice, "-ccobjflag"));
     opts.cc.outflag = aven_str_cstr(aven_arg_get_str(arg_slice, "-ccoutflag"));
     opts.cc.flagsep = aven_arg_get_int(arg_slice, "-ccflagsep");
+    // Flags end up as exec arguments, so they need NUL terminated copies
     opts.cc.flags = aven_str_split(
         aven_str_cstr(aven_arg_get_str(arg_slice, "-ccflags")),
         ' ',
@@ -631,27 +637,27 @@ static inline AvenBuildCommonOpts aven_build_common_opts(
         );
     }
 
-    opts.obexts = aven_str_split(
+    opts.obexts = aven_str_split_view(
         aven_str_cstr(aven_arg_get_str(arg_slice, "-obext")),
         ' ',
         arena
     );
-    opts.exexts = aven_str_split(
+    opts.exexts = aven_str_split_view(
         aven_str_cstr(aven_arg_get_str(arg_slice, "-exext")),
         ' ',
         arena
     );
-    opts.soexts = aven_str_split(
+    opts.soexts = aven_str_split_view(
         aven_str_cstr(aven_arg_get_str(arg_slice, "-soext")),
         ' ',
         arena
     );
-    opts.arexts = aven_str_split(
+    opts.arexts = aven_str_split_view(
         aven_str_cstr(aven_arg_get_str(arg_slice, "-arext")),
         ' ',
         arena
     );
-    opts.wrexts = aven_str_split(
+    opts.wrexts = aven_str_split_view(
         aven_str_cstr(aven_arg_get_str(arg_slice, "-wrext")),
         ' ',
         arena
@@ -660,6 +666,27 @@ static inline AvenBuildCommonOpts aven_build_common_opts(
     return opts;
 }
 
+// Concatenates a flag and its value, interning the result if enabled
+static inline AvenStr aven_build_common_flag(
+    AvenBuildCommonOpts *opts,
+    AvenStr flag,
+    AvenStr value,
+    AvenArena *arena
+) {
+    if (opts->intern == NULL) {
+        return aven_str_concat(flag, value, arena);
+    }
+
+    AvenArena saved_arena = *arena;
+    AvenStr str = aven_str_concat(flag, value, arena);
+    AvenStrIntern interned = aven_str_intern_owned(opts->intern, str, arena);
+    if (interned.str.ptr != str.ptr) {
+        // A duplicate, so the concatenation is the last allocation
+        *arena = saved_arena;
+    }
+    return interned.str;
+}
+
 static inline AvenBuildStep aven_build_common_step_subdir(
     AvenBuildStep *dir_step,
     AvenStr subdir_name,
@@ -668,8 +695,10 @@ static inline AvenBuildStep aven_build_common_step_subdir(
     assert(dir_step->out_path.valid);
     AvenStr dir_path = dir_step->out_path.value;
 
+    AvenStr parts_data[] = { dir_path, subdir_name };
+    AvenStrSlice parts = { .ptr = parts_data, .len = countof(parts_data) };
     AvenBuildStep subdir_step = aven_build_step_mkdir(
-        aven_path(arena, dir_path.ptr, subdir_name.ptr, NULL)
+        aven_path_join_slice(parts, arena)
     );
     aven_build_step_add_dep(&subdir_step, dir_step, arena);
     return subdir_step;
@@ -686,15 +715,14 @@ static inline void aven_build_common_step_add_path_deps(
     AvenStr dir_path = dir_step->out_path.value;
 
     for (size_t i = 0; i < exts.len; i += 1) {
+        AvenStr parts_data[] = {
+            dir_path,
+            aven_str_concat(fname, slice_get(exts, i), arena),
+        };
+        AvenStrSlice parts = { .ptr = parts_data, .len = countof(parts_data) };
+
         AvenBuildStep *path_step = aven_arena_create(AvenBuildStep, arena);
-        *path_step = aven_build_step_path(
-            aven_path(
-                arena,
-                dir_path.ptr,
-                aven_str_concat(fname, slice_get(exts, i), arena).ptr,
-                NULL
-            )
-        );
+        *path_step = aven_build_step_path(aven_path_join_slice(parts, arena));
         aven_build_step_add_dep(path_step, dir_step, arena);
         aven_build_step_add_dep(cmd_step, path_step, arena);
     }
@@ -727,12 +755,12 @@ static inline AvenBuildStep aven_build_common_step_cc_ex(
             arena
         );
     }
-    AvenStr target_path = aven_path(
-        arena,
-        out_dir_path.ptr,
-        out_fname.ptr,
-        NULL
-    );
+    AvenStr target_parts_data[] = { out_dir_path, out_fname };
+    AvenStrSlice target_parts = {
+        .ptr = target_parts_data,
+        .len = countof(target_parts_data),
+    };
+    AvenStr target_path = aven_path_join_slice(target_parts, arena);
 
     AvenStrSlice cmd_slice = {
         .len = 4 + opts->cc.flags.len + includes.len + macros.len
@@ -758,7 +786,8 @@ static inline AvenBuildStep aven_build_common_step_cc_ex(
             slice_get(cmd_slice, i) = slice_get(includes, j);
             i += 1;
         } else {
-            slice_get(cmd_slice, i) = aven_str_concat(
+            slice_get(cmd_slice, i) = aven_build_common_flag(
+                opts,
                 opts->cc.incflag,
                 slice_get(includes, j),
                 arena
@@ -774,7 +803,8 @@ static inline AvenBuildStep aven_build_common_step_cc_ex(
             slice_get(cmd_slice, i) = slice_get(macros, j);
             i += 1;
         } else {
-            slice_get(cmd_slice, i) = aven_str_concat(
+            slice_get(cmd_slice, i) = aven_build_common_flag(
+                opts,
                 opts->cc.defflag,
                 slice_get(macros, j),
                 arena
@@ -866,12 +896,12 @@ static AvenBuildStep aven_build_common_step_ld(
     if (exts.len > 0) {
         out_fname = aven_str_concat(out_fname, slice_get(exts, 0), arena);
     }
-    AvenStr target_path = aven_path(
-        arena,
-        out_dir_path.ptr,
-        out_fname.ptr,
-        NULL
-    );
+    AvenStr target_parts_data[] = { out_dir_path, out_fname };
+    AvenStrSlice target_parts = {
+        .ptr = target_parts_data,
+        .len = countof(target_parts_data),
+    };
+    AvenStr target_path = aven_path_join_slice(target_parts, arena);
 
     AvenStrSlice cmd_slice = { 0 };
     cmd_slice.len = 2 +
@@ -947,7 +977,8 @@ static AvenBuildStep aven_build_common_step_ld(
             slice_get(cmd_slice, i) = slice_get(linked_libs, j);
             i += 1;
         } else {
-            slice_get(cmd_slice, i) = aven_str_concat(
+            slice_get(cmd_slice, i) = aven_build_common_flag(
+                opts,
                 opts->ld.libflag,
                 slice_get(linked_libs, j),
                 arena
@@ -1078,12 +1109,12 @@ static inline AvenBuildStep aven_build_common_step_ar(
             arena
         );
     }
-    AvenStr target_path = aven_path(
-        arena,
-        out_dir_path.ptr,
-        out_fname.ptr,
-        NULL
-    );
+    AvenStr target_parts_data[] = { out_dir_path, out_fname };
+    AvenStrSlice target_parts = {
+        .ptr = target_parts_data,
+        .len = countof(target_parts_data),
+    };
+    AvenStr target_path = aven_path_join_slice(target_parts, arena);
 
     AvenStrSlice cmd_slice = { 0 };
     cmd_slice.len = 2 + opts->ar.flags.len + obj_steps.len;
@@ -1180,12 +1211,12 @@ static inline AvenBuildStep aven_build_common_step_windres(
             arena
         );
     }
-    AvenStr target_path = aven_path(
-        arena,
-        out_dir_path.ptr,
-        out_fname.ptr,
-        NULL
-    );
+    AvenStr target_parts_data[] = { out_dir_path, out_fname };
+    AvenStrSlice target_parts = {
+        .ptr = target_parts_data,
+        .len = countof(target_parts_data),
+    };
+    AvenStr target_path = aven_path_join_slice(target_parts, arena);
 
     AvenStrSlice cmd_slice = { .len = 4 + opts->windres.flags.len };
     cmd_slice.ptr = aven_arena_create_array(AvenStr, arena, cmd_slice.len);
@@ -2,7 +2,10 @@
 #define AVEN_FS_H
 
 #include "../aven.h"
+#include "arena.h"
+#include "hash.h"
 #include "str.h"
+#include "str/map.h"
 
 typedef enum {
     AVEN_FS_RM_ERROR_NONE = 0,
@@ -53,12 +56,249 @@ typedef enum {
 
 AVEN_FN int aven_fs_copy(AvenStr ipath, AvenStr opath);
 
+// Files at least this large are memory mapped, smaller files and non-regular
+// files (e.g. pipes) are read into the arena instead
+#ifndef AVEN_FS_MAP_MIN_SIZE
+    #define AVEN_FS_MAP_MIN_SIZE (64 * 1024)
+#endif
+
+typedef struct {
+    ByteSlice bytes;
+    bool mapped;
+} AvenFsMap;
+
+typedef Result(AvenFsMap) AvenFsMapResult;
+typedef enum {
+    AVEN_FS_MAP_ERROR_NONE = 0,
+    AVEN_FS_MAP_ERROR_OPEN,
+    AVEN_FS_MAP_ERROR_STAT,
+    AVEN_FS_MAP_ERROR_MAP,
+    AVEN_FS_MAP_ERROR_READ,
+} AvenFsMapError;
+
+AVEN_FN AvenFsMapResult aven_fs_map(AvenStr path, AvenArena *arena);
+AVEN_FN void aven_fs_unmap(AvenFsMap map);
+
+typedef Result(ByteSlice) AvenFsReadResult;
+typedef enum {
+    AVEN_FS_READ_ERROR_NONE = 0,
+    AVEN_FS_READ_ERROR_OPEN,
+    AVEN_FS_READ_ERROR_STAT,
+    AVEN_FS_READ_ERROR_READ,
+} AvenFsReadError;
+
+AVEN_FN AvenFsReadResult aven_fs_read(AvenStr path, AvenArena *arena);
+
+#define AVEN_FS_MAX_PATH_LEN 4096
+
+typedef enum {
+    AVEN_FS_WRITE_ERROR_NONE = 0,
+    AVEN_FS_WRITE_ERROR_BADPATH,
+    AVEN_FS_WRITE_ERROR_OPEN,
+    AVEN_FS_WRITE_ERROR_WRITE,
+    AVEN_FS_WRITE_ERROR_RENAME,
+} AvenFsWriteError;
+
+// Writes to a temporary file in the same directory, flushes it to disk, and
+// renames it over path, so readers never observe a partially written file.
+// An existing file keeps its permission bits but not its owner, on Windows
+// only the contents are replaced.
+AVEN_FN int aven_fs_write_atomic(AvenStr path, ByteSlice bytes);
+
+typedef struct {
+    int64_t mtime_sec;
+    uint32_t mtime_nsec;
+    uint64_t size;
+    uint64_t ino;
+} AvenFsStat;
+
+typedef Result(AvenFsStat) AvenFsStatResult;
+typedef enum {
+    AVEN_FS_STAT_ERROR_NONE = 0,
+    AVEN_FS_STAT_ERROR_BADPATH,
+    AVEN_FS_STAT_ERROR_ACCESS,
+    AVEN_FS_STAT_ERROR_OTHER,
+} AvenFsStatError;
+
+// Only queries the modification time, size, and inode (statx on Linux)
+AVEN_FN AvenFsStatResult aven_fs_stat(AvenStr path);
+
+typedef struct {
+    AvenFsStatResult result;
+    bool cached;
+} AvenFsStatCacheEntry;
+
+// Caches aven_fs_stat results (including errors) by path, in a map from
+// arena copies of the paths to AvenFsStatCacheEntry values. Entries must be
+// invalidated explicitly when a file may have changed, e.g. call
+// aven_fs_stat_cache_invalidate_dir for each directory signaled by
+// aven_watch_check.
+typedef struct {
+    AvenStrMap map;
+} AvenFsStatCache;
+
+AVEN_FN AvenFsStatCache aven_fs_stat_cache_init(
+    size_t capacity,
+    AvenArena *arena
+);
+AVEN_FN AvenFsStatResult aven_fs_stat_cache_get(
+    AvenFsStatCache *cache,
+    AvenStr path,
+    AvenArena *arena
+);
+AVEN_FN void aven_fs_stat_cache_invalidate(
+    AvenFsStatCache *cache,
+    AvenStr path
+);
+AVEN_FN void aven_fs_stat_cache_invalidate_dir(
+    AvenFsStatCache *cache,
+    AvenStr dir_path
+);
+AVEN_FN void aven_fs_stat_cache_clear(AvenFsStatCache *cache);
+
+typedef enum {
+    AVEN_FS_BATCH_OP_TYPE_MKDIR = 0,
+    AVEN_FS_BATCH_OP_TYPE_TRUNC,
+    AVEN_FS_BATCH_OP_TYPE_RM,
+    AVEN_FS_BATCH_OP_TYPE_COPY,
+    AVEN_FS_BATCH_OP_TYPE_STAT,
+} AvenFsBatchOpType;
+
+// The error is set to the error code of the corresponding aven_fs function,
+// e.g. an AvenFsCopyError for AVEN_FS_BATCH_OP_TYPE_COPY
+typedef struct {
+    AvenFsBatchOpType type;
+    AvenStr path;
+    AvenStr src_path;
+    AvenFsStat stat;
+    int error;
+} AvenFsBatchOp;
+
+typedef Slice(AvenFsBatchOp) AvenFsBatchOpSlice;
+
+static inline AvenFsBatchOp aven_fs_batch_op_mkdir(AvenStr dir_path) {
+    return (AvenFsBatchOp){
+        .type = AVEN_FS_BATCH_OP_TYPE_MKDIR,
+        .path = dir_path,
+    };
+}
+
+static inline AvenFsBatchOp aven_fs_batch_op_trunc(AvenStr file_path) {
+    return (AvenFsBatchOp){
+        .type = AVEN_FS_BATCH_OP_TYPE_TRUNC,
+        .path = file_path,
+    };
+}
+
+static inline AvenFsBatchOp aven_fs_batch_op_rm(AvenStr file_path) {
+    return (AvenFsBatchOp){
+        .type = AVEN_FS_BATCH_OP_TYPE_RM,
+        .path = file_path,
+    };
+}
+
+static inline AvenFsBatchOp aven_fs_batch_op_copy(
+    AvenStr in_file_path,
+    AvenStr out_file_path
+) {
+    return (AvenFsBatchOp){
+        .type = AVEN_FS_BATCH_OP_TYPE_COPY,
+        .path = out_file_path,
+        .src_path = in_file_path,
+    };
+}
+
+static inline AvenFsBatchOp aven_fs_batch_op_stat(AvenStr path) {
+    return (AvenFsBatchOp){
+        .type = AVEN_FS_BATCH_OP_TYPE_STAT,
+        .path = path,
+    };
+}
+
+#ifndef AVEN_FS_BATCH_MAX_INFLIGHT
+    #define AVEN_FS_BATCH_MAX_INFLIGHT 32
+#endif
+
+#ifndef AVEN_FS_BATCH_COPY_BUFFER_SIZE
+    #define AVEN_FS_BATCH_COPY_BUFFER_SIZE (64 * 1024)
+#endif
+
+typedef enum {
+    AVEN_FS_BATCH_ERROR_NONE = 0,
+    AVEN_FS_BATCH_ERROR_OP,
+} AvenFsBatchError;
+
+// Runs every op in the batch. On Linux up to AVEN_FS_BATCH_MAX_INFLIGHT ops
+// are kept in flight with io_uring, otherwise (or if io_uring is
+// unavailable) ops are run one at a time. Ops in a batch are unordered, so
+// dependent ops (e.g. mkdir then copy into the dir) need separate batches.
+// The arena holds copy buffers for the duration of the call.
+AVEN_FN int aven_fs_batch(AvenFsBatchOpSlice ops, AvenArena arena);
+
+#ifndef AVEN_FS_HASH_BUFFER_SIZE
+    #define AVEN_FS_HASH_BUFFER_SIZE (1024 * 1024)
+#endif
+
+typedef Result(AvenHash) AvenFsHashResult;
+typedef enum {
+    AVEN_FS_HASH_ERROR_NONE = 0,
+    AVEN_FS_HASH_ERROR_OPEN,
+    AVEN_FS_HASH_ERROR_READ,
+} AvenFsHashError;
+
+// Streams the file through aven_hash_update in AVEN_FS_HASH_BUFFER_SIZE reads,
+// the result equals aven_hash of the file contents. The arena holds the read
+// buffer for the duration of the call.
+AVEN_FN AvenFsHashResult aven_fs_hash(
+    AvenStr path,
+    uint64_t seed,
+    AvenArena arena
+);
+
+// A directory handle for operations relative to an already resolved directory,
+// so the kernel does not re-walk the full path on each call. Backed by an
+// O_PATH (or O_RDONLY) directory fd where the *at functions are available,
+// otherwise names are joined onto path, which must outlive the handle.
+// O_PATH is only used if the includer's feature macros expose it, e.g.
+// _GNU_SOURCE with glibc, and the O_RDONLY fallback needs read permission.
+typedef struct {
+    int fd;
+    AvenStr path;
+} AvenFsDir;
+
+typedef Result(AvenFsDir) AvenFsDirResult;
+typedef enum {
+    AVEN_FS_DIR_ERROR_NONE = 0,
+    AVEN_FS_DIR_ERROR_BADPATH,
+    AVEN_FS_DIR_ERROR_ACCESS,
+    AVEN_FS_DIR_ERROR_OTHER,
+} AvenFsDirError;
+
+AVEN_FN AvenFsDirResult aven_fs_dir_open(AvenStr path);
+AVEN_FN void aven_fs_dir_close(AvenFsDir dir);
+
+// The following return the same error codes as their path based counterparts
+AVEN_FN int aven_fs_dir_rm(AvenFsDir dir, AvenStr name);
+AVEN_FN int aven_fs_dir_rmdir(AvenFsDir dir, AvenStr name);
+AVEN_FN int aven_fs_dir_mkdir(AvenFsDir dir, AvenStr name);
+AVEN_FN int aven_fs_dir_trunc(AvenFsDir dir, AvenStr name);
+AVEN_FN int aven_fs_dir_copy(
+    AvenFsDir idir,
+    AvenStr iname,
+    AvenFsDir odir,
+    AvenStr oname
+);
+AVEN_FN AvenFsStatResult aven_fs_dir_stat(AvenFsDir dir, AvenStr name);
+
 AVEN_FN void aven_fs_utf8_mode(void);
 
 #ifdef AVEN_IMPLEMENTATION
 
 #include <errno.h>
 
+#include <stdio.h>
+#include <string.h>
+
 #ifdef _WIN32
     #if defined(_MSC_VER) and defined(__clang__)
         #pragma clang diagnostic push
@@ -67,11 +307,93 @@ AVEN_FN void aven_fs_utf8_mode(void);
     #include <direct.h>
     #include <fcntl.h>
     #include <io.h>
+    #include <process.h>
     #include <sys/stat.h>
 #else
     #include <fcntl.h>
+    #include <sys/mman.h>
     #include <sys/stat.h>
     #include <unistd.h>
+    #ifdef __linux__
+        #include <sys/syscall.h>
+
+        long syscall(long number, ...);
+    #endif
+
+    #if defined(_POSIX_C_SOURCE) and _POSIX_C_SOURCE >= 200809L
+        #define AVEN_FS_AT
+    #endif
+    #ifdef AT_FDCWD
+        #define AVEN_FS_AT_FDCWD AT_FDCWD
+    #else
+        #define AVEN_FS_AT_FDCWD (-100)
+    #endif
+#endif
+
+#ifndef _WIN32
+static int aven_fs_rm_error(int error) {
+    switch (error) {
+        case EACCES:
+            return AVEN_FS_RM_ERROR_ACCESS;
+        case ENOENT:
+            return AVEN_FS_RM_ERROR_BADPATH;
+        case EBUSY:
+            return AVEN_FS_RM_ERROR_ACCESS;
+        case ENOTDIR:
+        case EISDIR:
+            return AVEN_FS_RM_ERROR_BADPATH;
+        default:
+            return AVEN_FS_RM_ERROR_OTHER;
+    }
+}
+
+static int aven_fs_rmdir_error(int error) {
+    switch (error) {
+        case ENOTEMPTY:
+            return AVEN_FS_RMDIR_ERROR_NOTEMPTY;
+        case EACCES:
+            return AVEN_FS_RMDIR_ERROR_ACCESS;
+        case ENOENT:
+            return AVEN_FS_RMDIR_ERROR_BADPATH;
+        case EBUSY:
+            return AVEN_FS_RMDIR_ERROR_ACCESS;
+        case EINVAL:
+        case ENOTDIR:
+            return AVEN_FS_RMDIR_ERROR_BADPATH;
+        default:
+            return AVEN_FS_RMDIR_ERROR_OTHER;
+    }
+}
+
+static int aven_fs_mkdir_error(int error) {
+    switch (error) {
+        case EACCES:
+            return AVEN_FS_MKDIR_ERROR_ACCESS;
+        case ENOENT:
+            return AVEN_FS_MKDIR_ERROR_BADPATH;
+        case EEXIST:
+            return AVEN_FS_MKDIR_ERROR_EXIST;
+        case ENAMETOOLONG:
+        case ENOTDIR:
+            return AVEN_FS_MKDIR_ERROR_BADPATH;
+        default:
+            return AVEN_FS_MKDIR_ERROR_OTHER;
+    }
+}
+
+static int aven_fs_trunc_error(int error) {
+    switch (error) {
+        case EACCES:
+            return AVEN_FS_TRUNC_ERROR_ACCESS;
+        case ENOENT:
+            return AVEN_FS_TRUNC_ERROR_BADPATH;
+        case ENOTDIR:
+        case EISDIR:
+            return AVEN_FS_TRUNC_ERROR_BADPATH;
+        default:
+            return AVEN_FS_TRUNC_ERROR_OTHER;
+    }
+}
 #endif
 
 AVEN_FN int aven_fs_rm(AvenStr path) {
@@ -92,19 +414,7 @@ AVEN_FN int aven_fs_rm(AvenStr path) {
 #else
     int error = unlink(path.ptr);
     if (error != 0) {
-        switch (errno) {
-            case EACCES:
-                return AVEN_FS_RM_ERROR_ACCESS;
-            case ENOENT:
-                return AVEN_FS_RM_ERROR_BADPATH;
-            case EBUSY:
-                return AVEN_FS_RM_ERROR_ACCESS;
-            case ENOTDIR:
-            case EISDIR:
-                return AVEN_FS_RM_ERROR_BADPATH;
-            default:
-                return AVEN_FS_RM_ERROR_OTHER;
-        }
+        return aven_fs_rm_error(errno);
     }
 
     return 0;
@@ -131,23 +441,7 @@ AVEN_FN int aven_fs_rmdir(AvenStr path) {
 #else
     int error = rmdir(path.ptr);
     if (error != 0) {
-        switch (errno) {
-            case ENOTEMPTY:
-                return AVEN_FS_RMDIR_ERROR_NOTEMPTY;
-            case EACCES:
-                return AVEN_FS_RMDIR_ERROR_ACCESS;
-            case ENOENT:
-                return AVEN_FS_RMDIR_ERROR_BADPATH;
-#ifndef _WIN32
-            case EBUSY:
-                return AVEN_FS_RMDIR_ERROR_ACCESS;
-            case EINVAL:
-            case ENOTDIR:
-                return AVEN_FS_RMDIR_ERROR_BADPATH;
-#endif
-            default:
-                return AVEN_FS_RMDIR_ERROR_OTHER;
-        }
+        return aven_fs_rmdir_error(errno);
     }
 
     return 0;
@@ -177,19 +471,7 @@ AVEN_FN int aven_fs_mkdir(AvenStr path) {
         S_IRWXU | S_IRGRP | S_IXGRP | S_IROTH | S_IXOTH
     );
     if (error != 0) {
-        switch (errno) {
-            case EACCES:
-                return AVEN_FS_MKDIR_ERROR_ACCESS;
-            case ENOENT:
-                return AVEN_FS_MKDIR_ERROR_BADPATH;
-            case EEXIST:
-                return AVEN_FS_MKDIR_ERROR_EXIST;
-            case ENAMETOOLONG:
-            case ENOTDIR:
-                return AVEN_FS_MKDIR_ERROR_BADPATH;
-            default:
-                return AVEN_FS_MKDIR_ERROR_OTHER;
-        }
+        return aven_fs_mkdir_error(errno);
     }
 
     return 0;
@@ -227,17 +509,7 @@ AVEN_FN int aven_fs_trunc(AvenStr path) {
         );
     } while (fd < 0 and errno == EINTR);
     if (fd < 0) {
-        switch (errno) {
-            case EACCES:
-                return AVEN_FS_TRUNC_ERROR_ACCESS;
-            case ENOENT:
-                return AVEN_FS_TRUNC_ERROR_BADPATH;
-            case ENOTDIR:
-            case EISDIR:
-                return AVEN_FS_TRUNC_ERROR_BADPATH;
-            default:
-                return AVEN_FS_TRUNC_ERROR_OTHER;
-        }
+        return aven_fs_trunc_error(errno);
     }
 
     close(fd);
@@ -246,6 +518,36 @@ AVEN_FN int aven_fs_trunc(AvenStr path) {
 #endif
 }
 
+#ifndef _WIN32
+static int aven_fs_copy_fd(int ifd, int ofd) {
+    char buffer[4096];
+    ssize_t ilen = 0;
+    do {
+        do {
+            ilen = read(ifd, buffer, sizeof(buffer));
+        } while (ilen < 0 and errno == EINTR);
+        if (ilen < 0) {
+            return AVEN_FS_COPY_ERROR_IFREAD;
+        }
+        ssize_t written = 0;
+        while (written < ilen) {
+            ssize_t olen = write(
+                ofd,
+                &buffer[written],
+                (size_t)(ilen - written)
+            );
+            if (olen >= 0) {
+                written += olen;
+            } else if (errno != EINTR) {
+                return AVEN_FS_COPY_ERROR_OFWRITE;
+            }
+        }
+    } while (ilen > 0);
+
+    return 0;
+}
+#endif
+
 AVEN_FN int aven_fs_copy(AvenStr ipath, AvenStr opath) {
 #ifdef _WIN32
     AVEN_WIN32_FN(int) CopyFileA(
@@ -286,37 +588,1596 @@ AVEN_FN int aven_fs_copy(AvenStr ipath, AvenStr opath) {
         );
     } while (ofd < 0 and errno == EINTR);
     if (ofd < 0) {
+        close(ifd);
         return AVEN_FS_COPY_ERROR_OFOPEN;
     }
 
-    char buffer[4096];
-    ssize_t ilen = 0;
-    do {
-        do {
-            ilen = read(ifd, buffer, sizeof(buffer));
-        } while (ilen < 0 and errno == EINTR);
-        if (ilen < 0) {
-            return AVEN_FS_COPY_ERROR_IFREAD;
-        }
-        ssize_t written = 0;
-        while (written < ilen) {
-            ssize_t olen = write(
-                ofd,
-                &buffer[written],
-                (size_t)(ilen - written)
-            );
-            if (olen >= 0) {
-                written += olen;
-            } else if (errno != EINTR) {
-                return AVEN_FS_COPY_ERROR_OFWRITE;
-            }
-        }
-    } while (ilen > 0);
+    int error = aven_fs_copy_fd(ifd, ofd);
 
     close(ifd);
     close(ofd);
 
-    return 0;
+    return error;
+#endif
+}
+
+// Read up to size bytes from an open file into the arena with a single sized
+// read. When the size is unknown (e.g. pipes) the file is read until EOF into
+// an allocation that grows in place while nothing else is allocated.
+static bool aven_fs_read_fd(
+    int fd,
+    size_t size,
+    bool size_known,
+    ByteSlice *bytes,
+    AvenArena *arena
+) {
+    // Files in /proc, /sys and similar report a size of 0 but have contents,
+    // so only a nonzero size is trusted
+    size_known = size_known and size > 0;
+
+    size_t cap = size;
+    if (!size_known) {
+        cap = 4096;
+    }
+
+    unsigned char *mem = aven_arena_alloc(arena, cap, 1);
+    size_t len = 0;
+    for (;;) {
+        if (len == cap) {
+            if (size_known) {
+                break;
+            }
+
+            mem = aven_arena_realloc(arena, mem, cap, 2 * cap, 1);
+            cap = 2 * cap;
+        }
+#ifdef _WIN32
+        size_t count = min(cap - len, (size_t)0x7fffffff);
+        int nread = _read(fd, mem + len, (unsigned int)count);
+#else
+        ssize_t nread = read(fd, mem + len, cap - len);
+        if (nread < 0 and errno == EINTR) {
+            continue;
+        }
+#endif
+        if (nread < 0) {
+            return false;
+        }
+        if (nread == 0) {
+            break;
+        }
+        len += (size_t)nread;
+    }
+
+    // Give the unused tail back to the arena
+    aven_arena_resize(arena, mem, cap, len);
+    *bytes = (ByteSlice){ .ptr = mem, .len = len };
+    return true;
+}
+
+AVEN_FN AvenFsMapResult aven_fs_map(AvenStr path, AvenArena *arena) {
+    AvenFsMap map = { 0 };
+#ifdef _WIN32
+    // Windows files are always read into the arena
+    int fd = _open(path.ptr, _O_RDONLY | _O_BINARY);
+    if (fd < 0) {
+        return (AvenFsMapResult){ .error = AVEN_FS_MAP_ERROR_OPEN };
+    }
+
+    struct _stati64 info;
+    if (_fstati64(fd, &info) != 0) {
+        _close(fd);
+        return (AvenFsMapResult){ .error = AVEN_FS_MAP_ERROR_STAT };
+    }
+
+    bool regular = (info.st_mode & _S_IFMT) == _S_IFREG;
+    if (regular and (uint64_t)info.st_size > SIZE_MAX) {
+        _close(fd);
+        return (AvenFsMapResult){ .error = AVEN_FS_MAP_ERROR_READ };
+    }
+
+    bool success = aven_fs_read_fd(
+        fd,
+        regular ? (size_t)info.st_size : 0,
+        regular,
+        &map.bytes,
+        arena
+    );
+    _close(fd);
+#else
+    int fd = -1;
+    do {
+        fd = open(path.ptr, O_RDONLY, 0);
+    } while (fd < 0 and errno == EINTR);
+    if (fd < 0) {
+        return (AvenFsMapResult){ .error = AVEN_FS_MAP_ERROR_OPEN };
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) != 0) {
+        close(fd);
+        return (AvenFsMapResult){ .error = AVEN_FS_MAP_ERROR_STAT };
+    }
+
+    bool regular = S_ISREG(info.st_mode);
+    if (regular and (uint64_t)info.st_size > SIZE_MAX) {
+        close(fd);
+        return (AvenFsMapResult){ .error = AVEN_FS_MAP_ERROR_MAP };
+    }
+
+    if (regular and info.st_size >= AVEN_FS_MAP_MIN_SIZE) {
+        size_t len = (size_t)info.st_size;
+        void *mem = mmap(NULL, len, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (mem == MAP_FAILED) {
+            return (AvenFsMapResult){ .error = AVEN_FS_MAP_ERROR_MAP };
+        }
+
+        posix_madvise(mem, len, POSIX_MADV_SEQUENTIAL);
+
+        map.bytes = (ByteSlice){ .ptr = mem, .len = len };
+        map.mapped = true;
+        return (AvenFsMapResult){ .payload = map };
+    }
+
+    bool success = aven_fs_read_fd(
+        fd,
+        regular ? (size_t)info.st_size : 0,
+        regular,
+        &map.bytes,
+        arena
+    );
+    close(fd);
+#endif
+    if (!success) {
+        return (AvenFsMapResult){ .error = AVEN_FS_MAP_ERROR_READ };
+    }
+
+    return (AvenFsMapResult){ .payload = map };
+}
+
+AVEN_FN void aven_fs_unmap(AvenFsMap map) {
+#ifdef _WIN32
+    (void)map;
+#else
+    if (map.mapped) {
+        munmap(map.bytes.ptr, map.bytes.len);
+    }
+#endif
+}
+
+AVEN_FN AvenFsReadResult aven_fs_read(AvenStr path, AvenArena *arena) {
+#ifdef _WIN32
+    int fd = _open(path.ptr, _O_RDONLY | _O_BINARY);
+    if (fd < 0) {
+        return (AvenFsReadResult){ .error = AVEN_FS_READ_ERROR_OPEN };
+    }
+
+    struct _stati64 info;
+    if (_fstati64(fd, &info) != 0) {
+        _close(fd);
+        return (AvenFsReadResult){ .error = AVEN_FS_READ_ERROR_STAT };
+    }
+
+    bool regular = (info.st_mode & _S_IFMT) == _S_IFREG;
+#else
+    int fd = -1;
+    do {
+        fd = open(path.ptr, O_RDONLY, 0);
+    } while (fd < 0 and errno == EINTR);
+    if (fd < 0) {
+        return (AvenFsReadResult){ .error = AVEN_FS_READ_ERROR_OPEN };
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) != 0) {
+        close(fd);
+        return (AvenFsReadResult){ .error = AVEN_FS_READ_ERROR_STAT };
+    }
+
+    bool regular = S_ISREG(info.st_mode);
+#endif
+    ByteSlice bytes = { 0 };
+    bool success = (!regular or (uint64_t)info.st_size <= SIZE_MAX) and
+        aven_fs_read_fd(
+            fd,
+            regular ? (size_t)info.st_size : 0,
+            regular,
+            &bytes,
+            arena
+        );
+#ifdef _WIN32
+    _close(fd);
+#else
+    close(fd);
+#endif
+    if (!success) {
+        return (AvenFsReadResult){ .error = AVEN_FS_READ_ERROR_READ };
+    }
+
+    return (AvenFsReadResult){ .payload = bytes };
+}
+
+// Counts temporary files so concurrent writes within a process get distinct
+// names, the O_EXCL retry below still covers collisions with other processes
+// and with stale files left behind by a crash
+static unsigned long aven_fs_write_atomic_count;
+
+#if defined(_MSC_VER) and !defined(__clang__)
+    long _InterlockedIncrement(long volatile *addend);
+    #pragma intrinsic(_InterlockedIncrement)
+#endif
+
+static unsigned long aven_fs_write_atomic_next(void) {
+#if defined(__GNUC__) or defined(__clang__)
+    return __atomic_add_fetch(
+        &aven_fs_write_atomic_count,
+        1,
+        __ATOMIC_RELAXED
+    );
+#elif defined(_MSC_VER)
+    return (unsigned long)_InterlockedIncrement(
+        (long volatile *)&aven_fs_write_atomic_count
+    );
+#else
+    aven_fs_write_atomic_count += 1;
+    return aven_fs_write_atomic_count;
+#endif
+}
+
+static bool aven_fs_write_atomic_digits(
+    char *buffer,
+    size_t *len,
+    unsigned long n
+) {
+    char digits[24];
+    size_t digits_len = 0;
+    do {
+        digits[digits_len] = (char)('0' + (n % 10));
+        digits_len += 1;
+        n /= 10;
+    } while (n > 0);
+
+    if (*len + 1 + digits_len >= AVEN_FS_MAX_PATH_LEN) {
+        return false;
+    }
+
+    buffer[*len] = '.';
+    *len += 1;
+    for (size_t i = digits_len; i > 0; i -= 1) {
+        buffer[*len] = digits[i - 1];
+        *len += 1;
+    }
+
+    return true;
+}
+
+// Names the next temporary file for path as <path>.<pid>.<count>.tmp
+static bool aven_fs_write_atomic_tmp_path(
+    char buffer[AVEN_FS_MAX_PATH_LEN],
+    AvenStr path
+) {
+#ifdef _WIN32
+    unsigned long pid = (unsigned long)_getpid();
+#else
+    unsigned long pid = (unsigned long)getpid();
+#endif
+    if (path.len >= AVEN_FS_MAX_PATH_LEN) {
+        return false;
+    }
+
+    memcpy(buffer, path.ptr, path.len);
+    size_t len = path.len;
+    if (
+        !aven_fs_write_atomic_digits(buffer, &len, pid) or
+        !aven_fs_write_atomic_digits(
+            buffer,
+            &len,
+            aven_fs_write_atomic_next()
+        ) or
+        len + sizeof(".tmp") > AVEN_FS_MAX_PATH_LEN
+    ) {
+        return false;
+    }
+    memcpy(&buffer[len], ".tmp", sizeof(".tmp"));
+
+    return true;
+}
+
+#define AVEN_FS_WRITE_ATOMIC_ATTEMPTS 64
+
+AVEN_FN int aven_fs_write_atomic(AvenStr path, ByteSlice bytes) {
+    char tmp_path[AVEN_FS_MAX_PATH_LEN];
+    int fd = -1;
+
+#ifdef _WIN32
+    AVEN_WIN32_FN(int) MoveFileExA(
+        const char *existing_fname,
+        const char *new_fname,
+        uint32_t flags
+    );
+
+    for (
+        size_t attempt = 0;
+        fd < 0 and attempt < AVEN_FS_WRITE_ATOMIC_ATTEMPTS;
+        attempt += 1
+    ) {
+        if (!aven_fs_write_atomic_tmp_path(tmp_path, path)) {
+            return AVEN_FS_WRITE_ERROR_BADPATH;
+        }
+        fd = _open(
+            tmp_path,
+            _O_CREAT | _O_EXCL | _O_WRONLY | _O_BINARY,
+            _S_IREAD | _S_IWRITE
+        );
+        if (fd < 0 and errno != EEXIST) {
+            return AVEN_FS_WRITE_ERROR_OPEN;
+        }
+    }
+    if (fd < 0) {
+        return AVEN_FS_WRITE_ERROR_OPEN;
+    }
+
+    size_t written = 0;
+    while (written < bytes.len) {
+        size_t count = min(bytes.len - written, (size_t)0x7fffffff);
+        int olen = _write(fd, bytes.ptr + written, (unsigned int)count);
+        if (olen < 0) {
+            _close(fd);
+            _unlink(tmp_path);
+            return AVEN_FS_WRITE_ERROR_WRITE;
+        }
+        written += (size_t)olen;
+    }
+
+    // Flush the contents before the rename can publish them
+    if (_commit(fd) != 0) {
+        _close(fd);
+        _unlink(tmp_path);
+        return AVEN_FS_WRITE_ERROR_WRITE;
+    }
+
+    if (_close(fd) != 0) {
+        _unlink(tmp_path);
+        return AVEN_FS_WRITE_ERROR_WRITE;
+    }
+
+    int success = MoveFileExA(
+        tmp_path,
+        path.ptr,
+        0x1 /* MOVEFILE_REPLACE_EXISTING */
+    );
+    if (success == 0) {
+        _unlink(tmp_path);
+        return AVEN_FS_WRITE_ERROR_RENAME;
+    }
+
+    return 0;
+#else
+    struct stat info;
+    bool keep_mode = stat(path.ptr, &info) == 0 and S_ISREG(info.st_mode);
+
+    for (
+        size_t attempt = 0;
+        fd < 0 and attempt < AVEN_FS_WRITE_ATOMIC_ATTEMPTS;
+        attempt += 1
+    ) {
+        if (!aven_fs_write_atomic_tmp_path(tmp_path, path)) {
+            return AVEN_FS_WRITE_ERROR_BADPATH;
+        }
+        do {
+            fd = open(
+                tmp_path,
+                O_CREAT | O_EXCL | O_WRONLY,
+                S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH
+            );
+        } while (fd < 0 and errno == EINTR);
+        if (fd < 0 and errno != EEXIST) {
+            return AVEN_FS_WRITE_ERROR_OPEN;
+        }
+    }
+    if (fd < 0) {
+        return AVEN_FS_WRITE_ERROR_OPEN;
+    }
+
+    if (
+        keep_mode and
+        fchmod(fd, info.st_mode & (S_IRWXU | S_IRWXG | S_IRWXO)) != 0
+    ) {
+        close(fd);
+        unlink(tmp_path);
+        return AVEN_FS_WRITE_ERROR_OPEN;
+    }
+
+    size_t written = 0;
+    while (written < bytes.len) {
+        ssize_t olen = write(fd, bytes.ptr + written, bytes.len - written);
+        if (olen >= 0) {
+            written += (size_t)olen;
+        } else if (errno != EINTR) {
+            close(fd);
+            unlink(tmp_path);
+            return AVEN_FS_WRITE_ERROR_WRITE;
+        }
+    }
+
+    // Flush the contents before the rename can publish them, otherwise a
+    // crash may leave an empty file in place of the old one
+    if (fsync(fd) != 0) {
+        close(fd);
+        unlink(tmp_path);
+        return AVEN_FS_WRITE_ERROR_WRITE;
+    }
+
+    if (close(fd) != 0) {
+        unlink(tmp_path);
+        return AVEN_FS_WRITE_ERROR_WRITE;
+    }
+
+    if (rename(tmp_path, path.ptr) != 0) {
+        unlink(tmp_path);
+        return AVEN_FS_WRITE_ERROR_RENAME;
+    }
+
+    return 0;
+#endif
+}
+
+#if defined(__linux__) and defined(SYS_statx)
+    typedef struct {
+        int64_t tv_sec;
+        uint32_t tv_nsec;
+        int32_t reserved;
+    } AvenFsStatxTimestamp;
+
+    typedef struct {
+        uint32_t mask;
+        uint32_t blksize;
+        uint64_t attributes;
+        uint32_t nlink;
+        uint32_t uid;
+        uint32_t gid;
+        uint16_t mode;
+        uint16_t spare0;
+        uint64_t ino;
+        uint64_t size;
+        uint64_t blocks;
+        uint64_t attributes_mask;
+        AvenFsStatxTimestamp atime;
+        AvenFsStatxTimestamp btime;
+        AvenFsStatxTimestamp ctime;
+        AvenFsStatxTimestamp mtime;
+        uint32_t rdev_major;
+        uint32_t rdev_minor;
+        uint32_t dev_major;
+        uint32_t dev_minor;
+        uint64_t spare[14];
+    } AvenFsStatx;
+
+    #define AVEN_FS_STATX_MTIME 0x40U
+    #define AVEN_FS_STATX_INO 0x100U
+    #define AVEN_FS_STATX_SIZE 0x200U
+#endif
+
+static int aven_fs_stat_error(int error) {
+    switch (error) {
+        case EACCES:
+            return AVEN_FS_STAT_ERROR_ACCESS;
+        case ENOENT:
+        case ENOTDIR:
+        case ENAMETOOLONG:
+            return AVEN_FS_STAT_ERROR_BADPATH;
+        default:
+            return AVEN_FS_STAT_ERROR_OTHER;
+    }
+}
+
+#ifndef _WIN32
+static AvenFsStatResult aven_fs_stat_at(int dir_fd, const char *path) {
+    #if defined(__linux__) and defined(SYS_statx)
+        AvenFsStatx statx_info;
+        long statx_error = syscall(
+            SYS_statx,
+            dir_fd,
+            path,
+            0,
+            AVEN_FS_STATX_MTIME | AVEN_FS_STATX_SIZE | AVEN_FS_STATX_INO,
+            &statx_info
+        );
+        if (statx_error == 0) {
+            return (AvenFsStatResult){
+                .payload = {
+                    .mtime_sec = statx_info.mtime.tv_sec,
+                    .mtime_nsec = statx_info.mtime.tv_nsec,
+                    .size = statx_info.size,
+                    .ino = statx_info.ino,
+                },
+            };
+        }
+        if (errno != ENOSYS) {
+            return (AvenFsStatResult){ .error = aven_fs_stat_error(errno) };
+        }
+    #endif
+
+    struct stat info;
+    #ifdef AVEN_FS_AT
+        int error = fstatat(dir_fd, path, &info, 0);
+    #else
+        assert(dir_fd == AVEN_FS_AT_FDCWD);
+        int error = stat(path, &info);
+    #endif
+    if (error != 0) {
+        return (AvenFsStatResult){ .error = aven_fs_stat_error(errno) };
+    }
+
+    return (AvenFsStatResult){
+        .payload = {
+            .mtime_sec = (int64_t)info.st_mtime,
+    #ifdef AVEN_FS_AT
+            // Matches statx, st_mtim is POSIX 2008 like the *at functions
+            .mtime_nsec = (uint32_t)info.st_mtim.tv_nsec,
+    #endif
+            .size = (uint64_t)info.st_size,
+            .ino = (uint64_t)info.st_ino,
+        },
+    };
+}
+#endif
+
+AVEN_FN AvenFsStatResult aven_fs_stat(AvenStr path) {
+#ifdef _WIN32
+    struct _stati64 info;
+    if (_stati64(path.ptr, &info) != 0) {
+        return (AvenFsStatResult){ .error = aven_fs_stat_error(errno) };
+    }
+
+    return (AvenFsStatResult){
+        .payload = {
+            .mtime_sec = (int64_t)info.st_mtime,
+            .size = (uint64_t)info.st_size,
+        },
+    };
+#else
+    return aven_fs_stat_at(AVEN_FS_AT_FDCWD, path.ptr);
+#endif
+}
+
+AVEN_FN AvenFsStatCache aven_fs_stat_cache_init(
+    size_t capacity,
+    AvenArena *arena
+) {
+    return (AvenFsStatCache){
+        .map = aven_str_map_init_type(AvenFsStatCacheEntry, capacity, arena),
+    };
+}
+
+AVEN_FN AvenFsStatResult aven_fs_stat_cache_get(
+    AvenFsStatCache *cache,
+    AvenStr path,
+    AvenArena *arena
+) {
+    AvenFsStatCacheEntry *entry = aven_str_map_get(&cache->map, path);
+    if (entry == NULL) {
+        entry = aven_str_map_insert(
+            &cache->map,
+            aven_str_copy(path, arena),
+            arena
+        );
+    }
+
+    if (!entry->cached) {
+        entry->result = aven_fs_stat(path);
+        entry->cached = true;
+    }
+    return entry->result;
+}
+
+AVEN_FN void aven_fs_stat_cache_invalidate(
+    AvenFsStatCache *cache,
+    AvenStr path
+) {
+    AvenFsStatCacheEntry *entry = aven_str_map_get(&cache->map, path);
+    if (entry != NULL) {
+        entry->cached = false;
+    }
+}
+
+AVEN_FN void aven_fs_stat_cache_invalidate_dir(
+    AvenFsStatCache *cache,
+    AvenStr dir_path
+) {
+    size_t index = 0;
+    for (
+        AvenStrMapOptionalEntry map_entry = aven_str_map_next(
+            &cache->map,
+            &index
+        );
+        map_entry.valid;
+        map_entry = aven_str_map_next(&cache->map, &index)
+    ) {
+        AvenStr path = map_entry.value.key;
+        AvenFsStatCacheEntry *entry = map_entry.value.value;
+        if (!aven_str_starts_with(path, dir_path)) {
+            continue;
+        }
+
+        if (path.len > dir_path.len) {
+            char c = slice_get(path, dir_path.len);
+#ifdef _WIN32
+            if (c != '\\' and c != '/') {
+                continue;
+            }
+#else
+            if (c != '/') {
+                continue;
+            }
+#endif
+        }
+
+        entry->cached = false;
+    }
+}
+
+AVEN_FN void aven_fs_stat_cache_clear(AvenFsStatCache *cache) {
+    size_t index = 0;
+    for (
+        AvenStrMapOptionalEntry map_entry = aven_str_map_next(
+            &cache->map,
+            &index
+        );
+        map_entry.valid;
+        map_entry = aven_str_map_next(&cache->map, &index)
+    ) {
+        AvenFsStatCacheEntry *entry = map_entry.value.value;
+        entry->cached = false;
+    }
+}
+
+static void aven_fs_batch_op_run(AvenFsBatchOp *op) {
+    AvenFsStatResult stat_result;
+    switch (op->type) {
+        case AVEN_FS_BATCH_OP_TYPE_MKDIR:
+            op->error = aven_fs_mkdir(op->path);
+            break;
+        case AVEN_FS_BATCH_OP_TYPE_TRUNC:
+            op->error = aven_fs_trunc(op->path);
+            break;
+        case AVEN_FS_BATCH_OP_TYPE_RM:
+            op->error = aven_fs_rm(op->path);
+            break;
+        case AVEN_FS_BATCH_OP_TYPE_COPY:
+            op->error = aven_fs_copy(op->src_path, op->path);
+            break;
+        case AVEN_FS_BATCH_OP_TYPE_STAT:
+            stat_result = aven_fs_stat(op->path);
+            op->stat = stat_result.payload;
+            op->error = stat_result.error;
+            break;
+        default:
+            assert(false);
+            break;
+    }
+}
+
+#if defined(__linux__) and \
+    (defined(__GNUC__) or defined(__clang__)) and \
+    defined(SYS_io_uring_setup) and \
+    defined(SYS_io_uring_enter) and \
+    defined(SYS_statx)
+    #define AVEN_FS_BATCH_URING
+
+    typedef struct {
+        uint8_t opcode;
+        uint8_t flags;
+        uint16_t ioprio;
+        int32_t fd;
+        uint64_t off;
+        uint64_t addr;
+        uint32_t len;
+        uint32_t op_flags;
+        uint64_t user_data;
+        uint16_t buf_index;
+        uint16_t personality;
+        int32_t splice_fd_in;
+        uint64_t addr3;
+        uint64_t pad;
+    } AvenFsUringSqe;
+
+    typedef struct {
+        uint64_t user_data;
+        int32_t res;
+        uint32_t flags;
+    } AvenFsUringCqe;
+
+    typedef struct {
+        uint32_t head;
+        uint32_t tail;
+        uint32_t ring_mask;
+        uint32_t ring_entries;
+        uint32_t flags;
+        uint32_t dropped;
+        uint32_t array;
+        uint32_t resv1;
+        uint64_t resv2;
+    } AvenFsUringSqOffsets;
+
+    typedef struct {
+        uint32_t head;
+        uint32_t tail;
+        uint32_t ring_mask;
+        uint32_t ring_entries;
+        uint32_t overflow;
+        uint32_t cqes;
+        uint32_t flags;
+        uint32_t resv1;
+        uint64_t resv2;
+    } AvenFsUringCqOffsets;
+
+    typedef struct {
+        uint32_t sq_entries;
+        uint32_t cq_entries;
+        uint32_t flags;
+        uint32_t sq_thread_cpu;
+        uint32_t sq_thread_idle;
+        uint32_t features;
+        uint32_t wq_fd;
+        uint32_t resv[3];
+        AvenFsUringSqOffsets sq_off;
+        AvenFsUringCqOffsets cq_off;
+    } AvenFsUringParams;
+
+    #define AVEN_FS_URING_OP_OPENAT 18
+    #define AVEN_FS_URING_OP_STATX 21
+    #define AVEN_FS_URING_OP_READ 22
+    #define AVEN_FS_URING_OP_WRITE 23
+    #define AVEN_FS_URING_OP_UNLINKAT 36
+    #define AVEN_FS_URING_OP_MKDIRAT 37
+
+    #define AVEN_FS_URING_OFF_CQ_RING 0x8000000
+    #define AVEN_FS_URING_OFF_SQES 0x10000000
+    #define AVEN_FS_URING_FEAT_SINGLE_MMAP 0x1U
+    #define AVEN_FS_URING_ENTER_GETEVENTS 0x1U
+
+    typedef struct {
+        int fd;
+        unsigned char *sq_ring;
+        size_t sq_ring_size;
+        unsigned char *cq_ring;
+        size_t cq_ring_size;
+        AvenFsUringSqe *sqes;
+        size_t sqes_size;
+        uint32_t *sq_head;
+        uint32_t *sq_tail;
+        uint32_t *sq_mask;
+        uint32_t *sq_array;
+        uint32_t *cq_head;
+        uint32_t *cq_tail;
+        uint32_t *cq_mask;
+        AvenFsUringCqe *cqes;
+    } AvenFsUring;
+
+    typedef enum {
+        AVEN_FS_BATCH_STAGE_START = 0,
+        AVEN_FS_BATCH_STAGE_OPEN_OUT,
+        AVEN_FS_BATCH_STAGE_READ,
+        AVEN_FS_BATCH_STAGE_WRITE,
+    } AvenFsBatchStage;
+
+    typedef struct {
+        AvenFsBatchOp *op;
+        AvenFsBatchStage stage;
+        bool ready;
+        int ifd;
+        int ofd;
+        uint64_t offset;
+        uint32_t chunk_len;
+        uint32_t written;
+        unsigned char *buffer;
+        AvenFsStatx statx;
+    } AvenFsBatchSlot;
+
+    static void aven_fs_uring_deinit(AvenFsUring *ring) {
+        if (ring->sqes != NULL) {
+            munmap(ring->sqes, ring->sqes_size);
+        }
+        if (ring->cq_ring != NULL and ring->cq_ring != ring->sq_ring) {
+            munmap(ring->cq_ring, ring->cq_ring_size);
+        }
+        if (ring->sq_ring != NULL) {
+            munmap(ring->sq_ring, ring->sq_ring_size);
+        }
+        close(ring->fd);
+    }
+
+    static bool aven_fs_uring_init(AvenFsUring *ring, uint32_t entries) {
+        AvenFsUringParams params = { 0 };
+        long fd = syscall(SYS_io_uring_setup, entries, &params);
+        if (fd < 0) {
+            return false;
+        }
+
+        *ring = (AvenFsUring){ .fd = (int)fd };
+
+        ring->sq_ring_size = params.sq_off.array +
+            params.sq_entries * sizeof(uint32_t);
+        ring->cq_ring_size = params.cq_off.cqes +
+            params.cq_entries * sizeof(AvenFsUringCqe);
+        bool single_mmap = (params.features & AVEN_FS_URING_FEAT_SINGLE_MMAP)
+            != 0;
+        if (single_mmap) {
+            ring->sq_ring_size = max(ring->sq_ring_size, ring->cq_ring_size);
+            ring->cq_ring_size = ring->sq_ring_size;
+        }
+
+        void *sq_ring = mmap(
+            NULL,
+            ring->sq_ring_size,
+            PROT_READ | PROT_WRITE,
+            MAP_SHARED,
+            ring->fd,
+            0
+        );
+        if (sq_ring == MAP_FAILED) {
+            aven_fs_uring_deinit(ring);
+            return false;
+        }
+        ring->sq_ring = sq_ring;
+
+        if (single_mmap) {
+            ring->cq_ring = ring->sq_ring;
+        } else {
+            void *cq_ring = mmap(
+                NULL,
+                ring->cq_ring_size,
+                PROT_READ | PROT_WRITE,
+                MAP_SHARED,
+                ring->fd,
+                AVEN_FS_URING_OFF_CQ_RING
+            );
+            if (cq_ring == MAP_FAILED) {
+                aven_fs_uring_deinit(ring);
+                return false;
+            }
+            ring->cq_ring = cq_ring;
+        }
+
+        ring->sqes_size = params.sq_entries * sizeof(AvenFsUringSqe);
+        void *sqes = mmap(
+            NULL,
+            ring->sqes_size,
+            PROT_READ | PROT_WRITE,
+            MAP_SHARED,
+            ring->fd,
+            AVEN_FS_URING_OFF_SQES
+        );
+        if (sqes == MAP_FAILED) {
+            aven_fs_uring_deinit(ring);
+            return false;
+        }
+        ring->sqes = sqes;
+
+        ring->sq_head = (uint32_t *)(ring->sq_ring + params.sq_off.head);
+        ring->sq_tail = (uint32_t *)(ring->sq_ring + params.sq_off.tail);
+        ring->sq_mask = (uint32_t *)(ring->sq_ring + params.sq_off.ring_mask);
+        ring->sq_array = (uint32_t *)(ring->sq_ring + params.sq_off.array);
+        ring->cq_head = (uint32_t *)(ring->cq_ring + params.cq_off.head);
+        ring->cq_tail = (uint32_t *)(ring->cq_ring + params.cq_off.tail);
+        ring->cq_mask = (uint32_t *)(ring->cq_ring + params.cq_off.ring_mask);
+        ring->cqes = (AvenFsUringCqe *)(ring->cq_ring + params.cq_off.cqes);
+
+        return true;
+    }
+
+    static void aven_fs_batch_slot_prep(
+        AvenFsBatchSlot *slot,
+        AvenFsUringSqe *sqe,
+        uint64_t user_data
+    ) {
+        AvenFsBatchOp *op = slot->op;
+        *sqe = (AvenFsUringSqe){
+            .fd = AVEN_FS_AT_FDCWD,
+            .user_data = user_data,
+        };
+
+        switch (op->type) {
+            case AVEN_FS_BATCH_OP_TYPE_MKDIR:
+                sqe->opcode = AVEN_FS_URING_OP_MKDIRAT;
+                sqe->addr = (uint64_t)(uintptr_t)op->path.ptr;
+                sqe->len = S_IRWXU | S_IRGRP | S_IXGRP | S_IROTH | S_IXOTH;
+                break;
+            case AVEN_FS_BATCH_OP_TYPE_TRUNC:
+                sqe->opcode = AVEN_FS_URING_OP_OPENAT;
+                sqe->addr = (uint64_t)(uintptr_t)op->path.ptr;
+                sqe->len = S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH;
+                sqe->op_flags = O_CREAT | O_TRUNC | O_WRONLY;
+                break;
+            case AVEN_FS_BATCH_OP_TYPE_RM:
+                sqe->opcode = AVEN_FS_URING_OP_UNLINKAT;
+                sqe->addr = (uint64_t)(uintptr_t)op->path.ptr;
+                break;
+            case AVEN_FS_BATCH_OP_TYPE_STAT:
+                sqe->opcode = AVEN_FS_URING_OP_STATX;
+                sqe->addr = (uint64_t)(uintptr_t)op->path.ptr;
+                sqe->len = AVEN_FS_STATX_MTIME |
+                    AVEN_FS_STATX_SIZE |
+                    AVEN_FS_STATX_INO;
+                sqe->off = (uint64_t)(uintptr_t)&slot->statx;
+                break;
+            case AVEN_FS_BATCH_OP_TYPE_COPY:
+                switch (slot->stage) {
+                    case AVEN_FS_BATCH_STAGE_START:
+                        sqe->opcode = AVEN_FS_URING_OP_OPENAT;
+                        sqe->addr = (uint64_t)(uintptr_t)op->src_path.ptr;
+                        sqe->op_flags = O_RDONLY;
+                        break;
+                    case AVEN_FS_BATCH_STAGE_OPEN_OUT:
+                        sqe->opcode = AVEN_FS_URING_OP_OPENAT;
+                        sqe->addr = (uint64_t)(uintptr_t)op->path.ptr;
+                        sqe->len = S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH;
+                        sqe->op_flags = O_CREAT | O_TRUNC | O_WRONLY;
+                        break;
+                    case AVEN_FS_BATCH_STAGE_READ:
+                        sqe->opcode = AVEN_FS_URING_OP_READ;
+                        sqe->fd = slot->ifd;
+                        sqe->addr = (uint64_t)(uintptr_t)slot->buffer;
+                        sqe->len = AVEN_FS_BATCH_COPY_BUFFER_SIZE;
+                        sqe->off = slot->offset;
+                        break;
+                    case AVEN_FS_BATCH_STAGE_WRITE:
+                        sqe->opcode = AVEN_FS_URING_OP_WRITE;
+                        sqe->fd = slot->ofd;
+                        sqe->addr = (uint64_t)(uintptr_t)(
+                            slot->buffer + slot->written
+                        );
+                        sqe->len = slot->chunk_len - slot->written;
+                        sqe->off = slot->offset + slot->written;
+                        break;
+                }
+                break;
+            default:
+                assert(false);
+                break;
+        }
+    }
+
+    static void aven_fs_batch_slot_finish(AvenFsBatchSlot *slot, int error) {
+        if (slot->ifd >= 0) {
+            close(slot->ifd);
+        }
+        if (slot->ofd >= 0) {
+            close(slot->ofd);
+        }
+        slot->op->error = error;
+        slot->op = NULL;
+    }
+
+    static void aven_fs_batch_slot_complete(
+        AvenFsBatchSlot *slot,
+        int32_t res
+    ) {
+        AvenFsBatchOp *op = slot->op;
+        if (res == -EINTR or res == -EAGAIN) {
+            slot->ready = true;
+            return;
+        }
+
+        // Kernels predating an opcode reject it with EINVAL
+        if (res == -EINVAL and slot->stage == AVEN_FS_BATCH_STAGE_START) {
+            aven_fs_batch_op_run(op);
+            slot->op = NULL;
+            return;
+        }
+
+        switch (op->type) {
+            case AVEN_FS_BATCH_OP_TYPE_MKDIR:
+                aven_fs_batch_slot_finish(
+                    slot,
+                    res < 0 ? aven_fs_mkdir_error(-res) : 0
+                );
+                break;
+            case AVEN_FS_BATCH_OP_TYPE_TRUNC:
+                if (res < 0) {
+                    aven_fs_batch_slot_finish(slot, aven_fs_trunc_error(-res));
+                } else {
+                    slot->ofd = res;
+                    aven_fs_batch_slot_finish(slot, 0);
+                }
+                break;
+            case AVEN_FS_BATCH_OP_TYPE_RM:
+                aven_fs_batch_slot_finish(
+                    slot,
+                    res < 0 ? aven_fs_rm_error(-res) : 0
+                );
+                break;
+            case AVEN_FS_BATCH_OP_TYPE_STAT:
+                if (res < 0) {
+                    aven_fs_batch_slot_finish(slot, aven_fs_stat_error(-res));
+                } else {
+                    op->stat = (AvenFsStat){
+                        .mtime_sec = slot->statx.mtime.tv_sec,
+                        .mtime_nsec = slot->statx.mtime.tv_nsec,
+                        .size = slot->statx.size,
+                        .ino = slot->statx.ino,
+                    };
+                    aven_fs_batch_slot_finish(slot, 0);
+                }
+                break;
+            case AVEN_FS_BATCH_OP_TYPE_COPY:
+                switch (slot->stage) {
+                    case AVEN_FS_BATCH_STAGE_START:
+                        if (res < 0) {
+                            aven_fs_batch_slot_finish(
+                                slot,
+                                AVEN_FS_COPY_ERROR_IFOPEN
+                            );
+                            return;
+                        }
+                        slot->ifd = res;
+                        slot->stage = AVEN_FS_BATCH_STAGE_OPEN_OUT;
+                        break;
+                    case AVEN_FS_BATCH_STAGE_OPEN_OUT:
+                        if (res < 0) {
+                            aven_fs_batch_slot_finish(
+                                slot,
+                                AVEN_FS_COPY_ERROR_OFOPEN
+                            );
+                            return;
+                        }
+                        slot->ofd = res;
+                        slot->stage = AVEN_FS_BATCH_STAGE_READ;
+                        break;
+                    case AVEN_FS_BATCH_STAGE_READ:
+                        if (res < 0) {
+                            aven_fs_batch_slot_finish(
+                                slot,
+                                AVEN_FS_COPY_ERROR_IFREAD
+                            );
+                            return;
+                        }
+                        if (res == 0) {
+                            aven_fs_batch_slot_finish(slot, 0);
+                            return;
+                        }
+                        slot->chunk_len = (uint32_t)res;
+                        slot->written = 0;
+                        slot->stage = AVEN_FS_BATCH_STAGE_WRITE;
+                        break;
+                    case AVEN_FS_BATCH_STAGE_WRITE:
+                        if (res <= 0) {
+                            aven_fs_batch_slot_finish(
+                                slot,
+                                AVEN_FS_COPY_ERROR_OFWRITE
+                            );
+                            return;
+                        }
+                        slot->written += (uint32_t)res;
+                        if (slot->written == slot->chunk_len) {
+                            slot->offset += slot->chunk_len;
+                            slot->stage = AVEN_FS_BATCH_STAGE_READ;
+                        }
+                        break;
+                }
+                slot->ready = true;
+                break;
+            default:
+                assert(false);
+                break;
+        }
+    }
+
+    static int aven_fs_batch_op_error_other(AvenFsBatchOp *op) {
+        switch (op->type) {
+            case AVEN_FS_BATCH_OP_TYPE_MKDIR:
+                return AVEN_FS_MKDIR_ERROR_OTHER;
+            case AVEN_FS_BATCH_OP_TYPE_TRUNC:
+                return AVEN_FS_TRUNC_ERROR_OTHER;
+            case AVEN_FS_BATCH_OP_TYPE_RM:
+                return AVEN_FS_RM_ERROR_OTHER;
+            case AVEN_FS_BATCH_OP_TYPE_STAT:
+                return AVEN_FS_STAT_ERROR_OTHER;
+            case AVEN_FS_BATCH_OP_TYPE_COPY:
+                return AVEN_FS_COPY_ERROR_OTHER;
+            default:
+                assert(false);
+                return 0;
+        }
+    }
+
+    // Returns the number of completions reaped
+    static size_t aven_fs_batch_uring_reap(
+        AvenFsUring *ring,
+        AvenFsBatchSlot *slots
+    ) {
+        uint32_t head = *ring->cq_head;
+        uint32_t cq_tail = __atomic_load_n(ring->cq_tail, __ATOMIC_ACQUIRE);
+        size_t count = 0;
+        for (; head != cq_tail; head += 1) {
+            AvenFsUringCqe *cqe = &ring->cqes[head & *ring->cq_mask];
+            aven_fs_batch_slot_complete(&slots[cqe->user_data], cqe->res);
+            count += 1;
+        }
+        __atomic_store_n(ring->cq_head, head, __ATOMIC_RELEASE);
+        return count;
+    }
+
+    // After io_uring_enter fails, takes back the entries the kernel never
+    // consumed and waits out the requests it did, so afterwards no slot has
+    // a request in flight and each remaining op can safely run synchronously
+    static void aven_fs_batch_uring_abort(
+        AvenFsUring *ring,
+        AvenFsBatchSlot *slots,
+        size_t nslots
+    ) {
+        uint32_t head = __atomic_load_n(ring->sq_head, __ATOMIC_ACQUIRE);
+        uint32_t tail = *ring->sq_tail;
+        for (uint32_t i = head; i != tail; i += 1) {
+            slots[ring->sq_array[i & *ring->sq_mask]].ready = true;
+        }
+        __atomic_store_n(ring->sq_tail, head, __ATOMIC_RELEASE);
+
+        for (;;) {
+            size_t inflight = 0;
+            for (size_t i = 0; i < nslots; i += 1) {
+                if (slots[i].op != NULL and !slots[i].ready) {
+                    inflight += 1;
+                }
+            }
+            if (inflight == 0) {
+                return;
+            }
+
+            if (aven_fs_batch_uring_reap(ring, slots) > 0) {
+                continue;
+            }
+            long result = syscall(
+                SYS_io_uring_enter,
+                ring->fd,
+                0,
+                1,
+                AVEN_FS_URING_ENTER_GETEVENTS,
+                NULL,
+                0
+            );
+            if (result < 0 and errno != EINTR) {
+                break;
+            }
+        }
+
+        // The kernel may or may not have performed these, so neither report
+        // success nor run them again
+        for (size_t i = 0; i < nslots; i += 1) {
+            AvenFsBatchSlot *slot = &slots[i];
+            if (slot->op != NULL and !slot->ready) {
+                aven_fs_batch_slot_finish(
+                    slot,
+                    aven_fs_batch_op_error_other(slot->op)
+                );
+            }
+        }
+    }
+
+    // Returns false without running any ops if io_uring is unavailable
+    static bool aven_fs_batch_uring(
+        AvenFsBatchOpSlice ops,
+        AvenArena *arena
+    ) {
+        size_t nslots = min(ops.len, (size_t)AVEN_FS_BATCH_MAX_INFLIGHT);
+
+        AvenFsUring ring;
+        if (!aven_fs_uring_init(&ring, (uint32_t)nslots)) {
+            return false;
+        }
+
+        AvenFsBatchSlot *slots = aven_arena_create_array(
+            AvenFsBatchSlot,
+            arena,
+            nslots
+        );
+        for (size_t i = 0; i < nslots; i += 1) {
+            slots[i] = (AvenFsBatchSlot){ .ifd = -1, .ofd = -1 };
+        }
+
+        size_t next_op = 0;
+        for (;;) {
+            size_t active = 0;
+            uint32_t tail = *ring.sq_tail;
+            uint32_t nsubmit = 0;
+            for (size_t i = 0; i < nslots; i += 1) {
+                AvenFsBatchSlot *slot = &slots[i];
+                if (slot->op == NULL and next_op < ops.len) {
+                    AvenFsBatchOp *op = &slice_get(ops, next_op);
+                    next_op += 1;
+
+                    op->error = 0;
+                    slot->op = op;
+                    slot->stage = AVEN_FS_BATCH_STAGE_START;
+                    slot->ready = true;
+                    slot->ifd = -1;
+                    slot->ofd = -1;
+                    slot->offset = 0;
+                    if (
+                        op->type == AVEN_FS_BATCH_OP_TYPE_COPY and
+                        slot->buffer == NULL
+                    ) {
+                        slot->buffer = aven_arena_alloc(
+                            arena,
+                            AVEN_FS_BATCH_COPY_BUFFER_SIZE,
+                            16
+                        );
+                    }
+                }
+                if (slot->op == NULL) {
+                    continue;
+                }
+
+                active += 1;
+                if (!slot->ready) {
+                    continue;
+                }
+
+                aven_fs_batch_slot_prep(slot, &ring.sqes[i], i);
+                ring.sq_array[tail & *ring.sq_mask] = (uint32_t)i;
+                tail += 1;
+                nsubmit += 1;
+                slot->ready = false;
+            }
+            if (active == 0) {
+                break;
+            }
+
+            __atomic_store_n(ring.sq_tail, tail, __ATOMIC_RELEASE);
+
+            for (;;) {
+                long nsubmitted = syscall(
+                    SYS_io_uring_enter,
+                    ring.fd,
+                    nsubmit,
+                    1,
+                    AVEN_FS_URING_ENTER_GETEVENTS,
+                    NULL,
+                    0
+                );
+                if (nsubmitted >= 0) {
+                    nsubmit -= (uint32_t)nsubmitted;
+                    if (nsubmit == 0) {
+                        break;
+                    }
+                } else if (errno != EINTR and errno != EAGAIN) {
+                    // The ring failed: finish the ops with nothing in flight
+                    // synchronously, a partial copy restarts from scratch
+                    aven_fs_batch_uring_abort(&ring, slots, nslots);
+                    aven_fs_uring_deinit(&ring);
+                    for (size_t i = 0; i < nslots; i += 1) {
+                        AvenFsBatchSlot *slot = &slots[i];
+                        if (slot->op != NULL) {
+                            AvenFsBatchOp *op = slot->op;
+                            aven_fs_batch_slot_finish(slot, 0);
+                            aven_fs_batch_op_run(op);
+                        }
+                    }
+                    for (; next_op < ops.len; next_op += 1) {
+                        aven_fs_batch_op_run(&slice_get(ops, next_op));
+                    }
+                    return true;
+                }
+            }
+
+            aven_fs_batch_uring_reap(&ring, slots);
+        }
+
+        aven_fs_uring_deinit(&ring);
+        return true;
+    }
+#endif
+
+AVEN_FN int aven_fs_batch(AvenFsBatchOpSlice ops, AvenArena arena) {
+    if (ops.len == 0) {
+        return 0;
+    }
+
+    bool done = false;
+#ifdef AVEN_FS_BATCH_URING
+    done = aven_fs_batch_uring(ops, &arena);
+#else
+    (void)arena;
+#endif
+    if (!done) {
+        for (size_t i = 0; i < ops.len; i += 1) {
+            aven_fs_batch_op_run(&slice_get(ops, i));
+        }
+    }
+
+    for (size_t i = 0; i < ops.len; i += 1) {
+        if (slice_get(ops, i).error != 0) {
+            return AVEN_FS_BATCH_ERROR_OP;
+        }
+    }
+
+    return 0;
+}
+
+AVEN_FN AvenFsHashResult aven_fs_hash(
+    AvenStr path,
+    uint64_t seed,
+    AvenArena arena
+) {
+#ifdef _WIN32
+    int fd = _open(path.ptr, _O_RDONLY | _O_BINARY);
+#else
+    int fd = -1;
+    do {
+        fd = open(path.ptr, O_RDONLY, 0);
+    } while (fd < 0 and errno == EINTR);
+#endif
+    if (fd < 0) {
+        return (AvenFsHashResult){ .error = AVEN_FS_HASH_ERROR_OPEN };
+    }
+
+#ifndef _WIN32
+    posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+
+    unsigned char *buffer = aven_arena_alloc(
+        &arena,
+        AVEN_FS_HASH_BUFFER_SIZE,
+        32
+    );
+    AvenHashState state = aven_hash_init(seed);
+    for (;;) {
+#ifdef _WIN32
+        int nread = _read(fd, buffer, AVEN_FS_HASH_BUFFER_SIZE);
+#else
+        ssize_t nread = read(fd, buffer, AVEN_FS_HASH_BUFFER_SIZE);
+        if (nread < 0 and errno == EINTR) {
+            continue;
+        }
+#endif
+        if (nread < 0) {
+#ifdef _WIN32
+            _close(fd);
+#else
+            close(fd);
+#endif
+            return (AvenFsHashResult){ .error = AVEN_FS_HASH_ERROR_READ };
+        }
+        if (nread == 0) {
+            break;
+        }
+        aven_hash_update(
+            &state,
+            (ByteSlice){ .ptr = buffer, .len = (size_t)nread }
+        );
+    }
+
+#ifdef _WIN32
+    _close(fd);
+#else
+    close(fd);
+#endif
+
+    return (AvenFsHashResult){ .payload = aven_hash_digest(&state) };
+}
+
+#ifndef AVEN_FS_AT
+// Joins dir.path and name into buffer, returns false if it does not fit
+static bool aven_fs_dir_join(
+    char *buffer,
+    size_t buffer_len,
+    AvenFsDir dir,
+    AvenStr name
+) {
+    size_t len = dir.path.len + 1 + name.len;
+    if (len + 1 > buffer_len) {
+        return false;
+    }
+
+    memcpy(buffer, dir.path.ptr, dir.path.len);
+#ifdef _WIN32
+    buffer[dir.path.len] = '\\';
+#else
+    buffer[dir.path.len] = '/';
+#endif
+    memcpy(&buffer[dir.path.len + 1], name.ptr, name.len);
+    buffer[len] = 0;
+
+    return true;
+}
+#endif
+
+AVEN_FN AvenFsDirResult aven_fs_dir_open(AvenStr path) {
+#ifdef AVEN_FS_AT
+    #ifdef O_PATH
+        int flags = O_PATH | O_DIRECTORY;
+    #else
+        int flags = O_RDONLY | O_DIRECTORY;
+    #endif
+    int fd = -1;
+    do {
+        fd = open(path.ptr, flags);
+    } while (fd < 0 and errno == EINTR);
+    if (fd < 0) {
+        switch (errno) {
+            case ENOENT:
+            case ENOTDIR:
+            case ENAMETOOLONG:
+                return (AvenFsDirResult){ .error = AVEN_FS_DIR_ERROR_BADPATH };
+            case EACCES:
+                return (AvenFsDirResult){ .error = AVEN_FS_DIR_ERROR_ACCESS };
+            default:
+                return (AvenFsDirResult){ .error = AVEN_FS_DIR_ERROR_OTHER };
+        }
+    }
+
+    return (AvenFsDirResult){ .payload = { .fd = fd, .path = path } };
+#else
+    AvenFsStatResult stat_result = aven_fs_stat(path);
+    if (stat_result.error != 0) {
+        switch (stat_result.error) {
+            case AVEN_FS_STAT_ERROR_BADPATH:
+                return (AvenFsDirResult){ .error = AVEN_FS_DIR_ERROR_BADPATH };
+            case AVEN_FS_STAT_ERROR_ACCESS:
+                return (AvenFsDirResult){ .error = AVEN_FS_DIR_ERROR_ACCESS };
+            default:
+                return (AvenFsDirResult){ .error = AVEN_FS_DIR_ERROR_OTHER };
+        }
+    }
+
+    return (AvenFsDirResult){ .payload = { .fd = -1, .path = path } };
+#endif
+}
+
+AVEN_FN void aven_fs_dir_close(AvenFsDir dir) {
+#ifdef AVEN_FS_AT
+    close(dir.fd);
+#else
+    (void)dir;
+#endif
+}
+
+AVEN_FN int aven_fs_dir_rm(AvenFsDir dir, AvenStr name) {
+#ifdef AVEN_FS_AT
+    if (unlinkat(dir.fd, name.ptr, 0) != 0) {
+        return aven_fs_rm_error(errno);
+    }
+
+    return 0;
+#else
+    char buffer[AVEN_FS_MAX_PATH_LEN];
+    if (!aven_fs_dir_join(buffer, sizeof(buffer), dir, name)) {
+        return AVEN_FS_RM_ERROR_BADPATH;
+    }
+
+    return aven_fs_rm(aven_str_cstr(buffer));
+#endif
+}
+
+AVEN_FN int aven_fs_dir_rmdir(AvenFsDir dir, AvenStr name) {
+#ifdef AVEN_FS_AT
+    if (unlinkat(dir.fd, name.ptr, AT_REMOVEDIR) != 0) {
+        return aven_fs_rmdir_error(errno);
+    }
+
+    return 0;
+#else
+    char buffer[AVEN_FS_MAX_PATH_LEN];
+    if (!aven_fs_dir_join(buffer, sizeof(buffer), dir, name)) {
+        return AVEN_FS_RMDIR_ERROR_BADPATH;
+    }
+
+    return aven_fs_rmdir(aven_str_cstr(buffer));
+#endif
+}
+
+AVEN_FN int aven_fs_dir_mkdir(AvenFsDir dir, AvenStr name) {
+#ifdef AVEN_FS_AT
+    int error = mkdirat(
+        dir.fd,
+        name.ptr,
+        S_IRWXU | S_IRGRP | S_IXGRP | S_IROTH | S_IXOTH
+    );
+    if (error != 0) {
+        return aven_fs_mkdir_error(errno);
+    }
+
+    return 0;
+#else
+    char buffer[AVEN_FS_MAX_PATH_LEN];
+    if (!aven_fs_dir_join(buffer, sizeof(buffer), dir, name)) {
+        return AVEN_FS_MKDIR_ERROR_BADPATH;
+    }
+
+    return aven_fs_mkdir(aven_str_cstr(buffer));
+#endif
+}
+
+AVEN_FN int aven_fs_dir_trunc(AvenFsDir dir, AvenStr name) {
+#ifdef AVEN_FS_AT
+    int fd = -1;
+    do {
+        fd = openat(
+            dir.fd,
+            name.ptr,
+            O_CREAT | O_TRUNC | O_WRONLY,
+            S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH
+        );
+    } while (fd < 0 and errno == EINTR);
+    if (fd < 0) {
+        return aven_fs_trunc_error(errno);
+    }
+
+    close(fd);
+
+    return 0;
+#else
+    char buffer[AVEN_FS_MAX_PATH_LEN];
+    if (!aven_fs_dir_join(buffer, sizeof(buffer), dir, name)) {
+        return AVEN_FS_TRUNC_ERROR_BADPATH;
+    }
+
+    return aven_fs_trunc(aven_str_cstr(buffer));
+#endif
+}
+
+AVEN_FN int aven_fs_dir_copy(
+    AvenFsDir idir,
+    AvenStr iname,
+    AvenFsDir odir,
+    AvenStr oname
+) {
+#ifdef AVEN_FS_AT
+    int ifd = -1;
+    do {
+        ifd = openat(idir.fd, iname.ptr, O_RDONLY);
+    } while (ifd < 0 and errno == EINTR);
+    if (ifd < 0) {
+        return AVEN_FS_COPY_ERROR_IFOPEN;
+    }
+
+    int ofd = -1;
+    do {
+        ofd = openat(
+            odir.fd,
+            oname.ptr,
+            O_CREAT | O_TRUNC | O_WRONLY,
+            S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH
+        );
+    } while (ofd < 0 and errno == EINTR);
+    if (ofd < 0) {
+        close(ifd);
+        return AVEN_FS_COPY_ERROR_OFOPEN;
+    }
+
+    int error = aven_fs_copy_fd(ifd, ofd);
+
+    close(ifd);
+    close(ofd);
+
+    return error;
+#else
+    char ibuffer[AVEN_FS_MAX_PATH_LEN];
+    if (!aven_fs_dir_join(ibuffer, sizeof(ibuffer), idir, iname)) {
+        return AVEN_FS_COPY_ERROR_IFOPEN;
+    }
+
+    char obuffer[AVEN_FS_MAX_PATH_LEN];
+    if (!aven_fs_dir_join(obuffer, sizeof(obuffer), odir, oname)) {
+        return AVEN_FS_COPY_ERROR_OFOPEN;
+    }
+
+    return aven_fs_copy(aven_str_cstr(ibuffer), aven_str_cstr(obuffer));
+#endif
+}
+
+AVEN_FN AvenFsStatResult aven_fs_dir_stat(AvenFsDir dir, AvenStr name) {
+#ifdef AVEN_FS_AT
+    return aven_fs_stat_at(dir.fd, name.ptr);
+#else
+    char buffer[AVEN_FS_MAX_PATH_LEN];
+    if (!aven_fs_dir_join(buffer, sizeof(buffer), dir, name)) {
+        return (AvenFsStatResult){ .error = AVEN_FS_STAT_ERROR_BADPATH };
+    }
+
+    return aven_fs_stat(aven_str_cstr(buffer));
 #endif
 }
 
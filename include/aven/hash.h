@@ -0,0 +1,635 @@
+#ifndef AVEN_HASH_H
+#define AVEN_HASH_H
+
+#include "../aven.h"
+
+// A fast non-cryptographic 128-bit hash for fingerprinting, modeled after
+// XXH3: the input is consumed as 64 byte stripes into eight 64-bit lanes,
+// with SSE2 and AVX2 kernels selected at runtime. Hashes are stable across
+// kernels and platforms, but are not compatible with XXH3 itself.
+
+#define AVEN_HASH_STRIPE_LEN 64
+#define AVEN_HASH_BLOCK_STRIPES 16
+#define AVEN_HASH_BLOCK_LEN (AVEN_HASH_STRIPE_LEN * AVEN_HASH_BLOCK_STRIPES)
+#define AVEN_HASH_SECRET_WORDS 32
+#define AVEN_HASH_SHORT_MAX 240
+
+typedef struct {
+    uint64_t lo;
+    uint64_t hi;
+} AvenHash;
+
+typedef enum {
+    AVEN_HASH_IMPL_AUTO = 0,
+    AVEN_HASH_IMPL_SCALAR,
+    AVEN_HASH_IMPL_SSE2,
+    AVEN_HASH_IMPL_AVX2,
+} AvenHashImpl;
+
+// The buffer holds the last stripe of previously consumed input followed by
+// up to one block of pending input, since the final stripe of a long input
+// is always the last AVEN_HASH_STRIPE_LEN bytes
+typedef struct {
+    uint64_t acc[8];
+    uint64_t secret[AVEN_HASH_SECRET_WORDS];
+    uint64_t seed;
+    uint64_t total_len;
+    size_t buffer_len;
+    AvenHashImpl impl;
+    unsigned char buffer[AVEN_HASH_STRIPE_LEN + AVEN_HASH_BLOCK_LEN];
+} AvenHashState;
+
+static inline bool aven_hash_eq(AvenHash a, AvenHash b) {
+    return a.lo == b.lo and a.hi == b.hi;
+}
+
+AVEN_FN bool aven_hash_impl_supported(AvenHashImpl impl);
+
+AVEN_FN AvenHash aven_hash(ByteSlice bytes, uint64_t seed);
+
+// Set state.impl after init to force a specific kernel (e.g. for testing)
+AVEN_FN AvenHashState aven_hash_init(uint64_t seed);
+AVEN_FN void aven_hash_update(AvenHashState *state, ByteSlice bytes);
+AVEN_FN AvenHash aven_hash_digest(AvenHashState *state);
+
+#ifdef AVEN_IMPLEMENTATION
+
+#include <string.h>
+
+#if defined(__SSE2__) or defined(_M_X64) or \
+    (defined(_M_IX86_FP) and _M_IX86_FP >= 2)
+    #define AVEN_HASH_SSE2
+    #include <emmintrin.h>
+#endif
+
+#if defined(AVEN_HASH_SSE2) and ( \
+        defined(__AVX2__) or ( \
+            (defined(__GNUC__) or defined(__clang__)) and \
+            (defined(__x86_64__) or defined(__i386__)) \
+        ) \
+    )
+    #define AVEN_HASH_AVX2
+    #include <immintrin.h>
+    #ifdef __AVX2__
+        #define AVEN_HASH_AVX2_FN static
+    #else
+        #define AVEN_HASH_AVX2_FN static __attribute__((target("avx2")))
+    #endif
+#endif
+
+#define AVEN_HASH_PRIME32_1 0x9e3779b1U
+#define AVEN_HASH_PRIME32_2 0x85ebca77U
+#define AVEN_HASH_PRIME32_3 0xc2b2ae3dU
+#define AVEN_HASH_PRIME64_1 0x9e3779b185ebca87ULL
+#define AVEN_HASH_PRIME64_2 0xc2b2ae3d27d4eb4fULL
+#define AVEN_HASH_PRIME64_3 0x165667b19e3779f9ULL
+#define AVEN_HASH_PRIME64_4 0x85ebca77c2b2ae63ULL
+#define AVEN_HASH_PRIME64_5 0x27d4eb2f165667c5ULL
+
+// Word offsets into the secret, stripe s of a block uses words s through s + 7
+#define AVEN_HASH_SECRET_LAST_STRIPE 23
+#define AVEN_HASH_SECRET_SCRAMBLE 24
+#define AVEN_HASH_SECRET_MERGE_LO 3
+#define AVEN_HASH_SECRET_MERGE_HI 17
+
+// Generated with splitmix64, seeded secrets add or subtract the seed
+static const uint64_t aven_hash_secret_default[AVEN_HASH_SECRET_WORDS] = {
+    0xf88bb8a8724c81ecULL, 0x1b39896a51a8749bULL,
+    0x53cb9f0c747ea2eaULL, 0x2c829abe1f4532e1ULL,
+    0xc584133ac916ab3cULL, 0x3ee5789041c98ac3ULL,
+    0xf3b8488c368cb0a6ULL, 0x657eecdd3cb13d09ULL,
+    0xc2d326e0055bdef6ULL, 0x8621a03fe0bbdb7bULL,
+    0x8e1f7555983aa92fULL, 0xb54e0f1600cc4d19ULL,
+    0x84bb3f97971d80abULL, 0x7d29825c75521255ULL,
+    0xc3cf17102b7f7f86ULL, 0x3466e9a083914f64ULL,
+    0xd81a8d2b5a4485acULL, 0xdb01602b100b9ed7ULL,
+    0xa9038a921825f10dULL, 0xedf5f1d90dca2f6aULL,
+    0x54496ad67bd2634cULL, 0xdd7c01d4f5407269ULL,
+    0x935e82f1db4c4f7bULL, 0x69b82ebc92233300ULL,
+    0x40d29eb57de1d510ULL, 0xa2f09dabb45c6316ULL,
+    0xee521d7a0f4d3872ULL, 0xf16952ee72f3454fULL,
+    0x377d35dea8e40225ULL, 0x0c7de8064963bab0ULL,
+    0x05582d37111ac529ULL, 0xd254741f599dc6f7ULL,
+};
+
+static inline uint64_t aven_hash_key(uint64_t seed, size_t i) {
+    if ((i & 1) == 0) {
+        return aven_hash_secret_default[i] + seed;
+    }
+    return aven_hash_secret_default[i] - seed;
+}
+
+static inline uint64_t aven_hash_read64(const unsigned char *p) {
+#if defined(__BYTE_ORDER__) and __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    uint64_t value = 0;
+    for (size_t i = 0; i < 8; i += 1) {
+        value |= (uint64_t)p[i] << (8 * i);
+    }
+    return value;
+#else
+    uint64_t value;
+    memcpy(&value, p, sizeof(value));
+    return value;
+#endif
+}
+
+static inline uint64_t aven_hash_read32(const unsigned char *p) {
+    return (uint64_t)p[0] |
+        ((uint64_t)p[1] << 8) |
+        ((uint64_t)p[2] << 16) |
+        ((uint64_t)p[3] << 24);
+}
+
+static inline uint64_t aven_hash_rotl(uint64_t x, unsigned int r) {
+    return (x << r) | (x >> (64 - r));
+}
+
+#ifdef __SIZEOF_INT128__
+    __extension__ typedef unsigned __int128 AvenHashU128;
+#endif
+
+// The 128-bit product of a and b with the high and low halves xored
+static inline uint64_t aven_hash_mul128_fold64(uint64_t a, uint64_t b) {
+#ifdef __SIZEOF_INT128__
+    AvenHashU128 product = (AvenHashU128)a * b;
+    return (uint64_t)product ^ (uint64_t)(product >> 64);
+#else
+    uint64_t a_lo = a & 0xffffffff;
+    uint64_t a_hi = a >> 32;
+    uint64_t b_lo = b & 0xffffffff;
+    uint64_t b_hi = b >> 32;
+
+    uint64_t lo_lo = a_lo * b_lo;
+    uint64_t hi_lo = a_hi * b_lo;
+    uint64_t lo_hi = a_lo * b_hi;
+    uint64_t hi_hi = a_hi * b_hi;
+
+    uint64_t cross = (lo_lo >> 32) + (hi_lo & 0xffffffff) + lo_hi;
+    uint64_t upper = (hi_lo >> 32) + (cross >> 32) + hi_hi;
+    uint64_t lower = (cross << 32) | (lo_lo & 0xffffffff);
+    return lower ^ upper;
+#endif
+}
+
+static inline uint64_t aven_hash_avalanche(uint64_t h) {
+    h ^= h >> 37;
+    h *= 0x165667919e3779f9ULL;
+    h ^= h >> 32;
+    return h;
+}
+
+static AvenHash aven_hash_short(
+    const unsigned char *p,
+    size_t len,
+    uint64_t seed
+) {
+    assert(len <= AVEN_HASH_SHORT_MAX);
+
+    uint64_t len64 = (uint64_t)len;
+    uint64_t lo = aven_hash_key(seed, 0) ^ (len64 * AVEN_HASH_PRIME64_1);
+    uint64_t hi = aven_hash_key(seed, 1) - (len64 * AVEN_HASH_PRIME64_2);
+
+    if (len <= 16) {
+        uint64_t a = 0;
+        uint64_t b = 0;
+        if (len >= 8) {
+            a = aven_hash_read64(p);
+            b = aven_hash_read64(p + len - 8);
+        } else if (len >= 4) {
+            a = aven_hash_read32(p);
+            b = aven_hash_read32(p + len - 4);
+        } else if (len > 0) {
+            a = (uint64_t)p[0] |
+                ((uint64_t)p[len >> 1] << 8) |
+                ((uint64_t)p[len - 1] << 16);
+            b = a;
+        }
+
+        lo += aven_hash_mul128_fold64(
+            a ^ aven_hash_key(seed, 2),
+            b ^ aven_hash_key(seed, 3)
+        );
+        hi += aven_hash_mul128_fold64(
+            b ^ aven_hash_key(seed, 4),
+            a ^ aven_hash_key(seed, 5)
+        );
+    } else {
+        // Every chunk but the last, which may overlap the previous one
+        size_t nchunks = (len - 1) / 16;
+        for (size_t i = 0; i < nchunks; i += 1) {
+            uint64_t a = aven_hash_read64(p + 16 * i);
+            uint64_t b = aven_hash_read64(p + 16 * i + 8);
+            lo += aven_hash_mul128_fold64(
+                a ^ aven_hash_key(seed, 2 + i),
+                b ^ aven_hash_key(seed, 17 + i)
+            );
+            lo = aven_hash_rotl(lo, 27) * AVEN_HASH_PRIME64_1;
+            hi += aven_hash_mul128_fold64(
+                b ^ aven_hash_key(seed, 31 - i),
+                a ^ aven_hash_key(seed, 16 - i)
+            );
+            hi = aven_hash_rotl(hi, 31) * AVEN_HASH_PRIME64_2;
+        }
+
+        uint64_t a = aven_hash_read64(p + len - 16);
+        uint64_t b = aven_hash_read64(p + len - 8);
+        lo += aven_hash_mul128_fold64(
+            a ^ aven_hash_key(seed, 16),
+            b ^ aven_hash_key(seed, 31)
+        );
+        hi += aven_hash_mul128_fold64(
+            b ^ aven_hash_key(seed, 2),
+            a ^ aven_hash_key(seed, 15)
+        );
+    }
+
+    return (AvenHash){
+        .lo = aven_hash_avalanche(lo + hi),
+        .hi = aven_hash_avalanche(hi ^ (lo * AVEN_HASH_PRIME64_3)),
+    };
+}
+
+static inline void aven_hash_stripe_scalar(
+    uint64_t acc[8],
+    const unsigned char *p,
+    const uint64_t *key
+) {
+    for (size_t i = 0; i < 8; i += 1) {
+        uint64_t data = aven_hash_read64(p + 8 * i);
+        uint64_t data_key = data ^ key[i];
+        acc[i ^ 1] += data;
+        acc[i] += (data_key & 0xffffffff) * (data_key >> 32);
+    }
+}
+
+static inline void aven_hash_scramble_scalar(
+    uint64_t acc[8],
+    const uint64_t *key
+) {
+    for (size_t i = 0; i < 8; i += 1) {
+        uint64_t a = acc[i];
+        a ^= a >> 47;
+        a ^= key[i];
+        acc[i] = a * AVEN_HASH_PRIME32_1;
+    }
+}
+
+static void aven_hash_blocks_scalar(
+    uint64_t acc[8],
+    const unsigned char *p,
+    size_t nblocks,
+    const uint64_t *secret
+) {
+    for (size_t b = 0; b < nblocks; b += 1) {
+        for (size_t s = 0; s < AVEN_HASH_BLOCK_STRIPES; s += 1) {
+            aven_hash_stripe_scalar(
+                acc,
+                p + AVEN_HASH_STRIPE_LEN * s,
+                secret + s
+            );
+        }
+        aven_hash_scramble_scalar(acc, secret + AVEN_HASH_SECRET_SCRAMBLE);
+        p += AVEN_HASH_BLOCK_LEN;
+    }
+}
+
+#ifdef AVEN_HASH_SSE2
+static void aven_hash_blocks_sse2(
+    uint64_t acc[8],
+    const unsigned char *p,
+    size_t nblocks,
+    const uint64_t *secret
+) {
+    __m128i a[4];
+    for (size_t i = 0; i < 4; i += 1) {
+        a[i] = _mm_loadu_si128((const __m128i *)(acc + 2 * i));
+    }
+
+    __m128i prime = _mm_set1_epi64x((long long)AVEN_HASH_PRIME32_1);
+    for (size_t b = 0; b < nblocks; b += 1) {
+        for (size_t s = 0; s < AVEN_HASH_BLOCK_STRIPES; s += 1) {
+            const unsigned char *stripe = p + AVEN_HASH_STRIPE_LEN * s;
+            for (size_t i = 0; i < 4; i += 1) {
+                __m128i data = _mm_loadu_si128(
+                    (const __m128i *)(stripe + 16 * i)
+                );
+                __m128i key = _mm_loadu_si128(
+                    (const __m128i *)(secret + s + 2 * i)
+                );
+                __m128i data_key = _mm_xor_si128(data, key);
+                __m128i data_key_hi = _mm_shuffle_epi32(
+                    data_key,
+                    _MM_SHUFFLE(0, 3, 0, 1)
+                );
+                __m128i product = _mm_mul_epu32(data_key, data_key_hi);
+                __m128i swapped = _mm_shuffle_epi32(
+                    data,
+                    _MM_SHUFFLE(1, 0, 3, 2)
+                );
+                a[i] = _mm_add_epi64(a[i], _mm_add_epi64(product, swapped));
+            }
+        }
+
+        for (size_t i = 0; i < 4; i += 1) {
+            __m128i key = _mm_loadu_si128(
+                (const __m128i *)(secret + AVEN_HASH_SECRET_SCRAMBLE + 2 * i)
+            );
+            __m128i x = _mm_xor_si128(a[i], _mm_srli_epi64(a[i], 47));
+            x = _mm_xor_si128(x, key);
+            __m128i x_hi = _mm_shuffle_epi32(x, _MM_SHUFFLE(0, 3, 0, 1));
+            __m128i product_lo = _mm_mul_epu32(x, prime);
+            __m128i product_hi = _mm_mul_epu32(x_hi, prime);
+            a[i] = _mm_add_epi64(product_lo, _mm_slli_epi64(product_hi, 32));
+        }
+
+        p += AVEN_HASH_BLOCK_LEN;
+    }
+
+    for (size_t i = 0; i < 4; i += 1) {
+        _mm_storeu_si128((__m128i *)(acc + 2 * i), a[i]);
+    }
+}
+#endif
+
+#ifdef AVEN_HASH_AVX2
+AVEN_HASH_AVX2_FN void aven_hash_blocks_avx2(
+    uint64_t acc[8],
+    const unsigned char *p,
+    size_t nblocks,
+    const uint64_t *secret
+) {
+    __m256i a[2];
+    for (size_t i = 0; i < 2; i += 1) {
+        a[i] = _mm256_loadu_si256((const __m256i *)(acc + 4 * i));
+    }
+
+    __m256i prime = _mm256_set1_epi64x((long long)AVEN_HASH_PRIME32_1);
+    for (size_t b = 0; b < nblocks; b += 1) {
+        for (size_t s = 0; s < AVEN_HASH_BLOCK_STRIPES; s += 1) {
+            const unsigned char *stripe = p + AVEN_HASH_STRIPE_LEN * s;
+            for (size_t i = 0; i < 2; i += 1) {
+                __m256i data = _mm256_loadu_si256(
+                    (const __m256i *)(stripe + 32 * i)
+                );
+                __m256i key = _mm256_loadu_si256(
+                    (const __m256i *)(secret + s + 4 * i)
+                );
+                __m256i data_key = _mm256_xor_si256(data, key);
+                __m256i data_key_hi = _mm256_shuffle_epi32(
+                    data_key,
+                    _MM_SHUFFLE(0, 3, 0, 1)
+                );
+                __m256i product = _mm256_mul_epu32(data_key, data_key_hi);
+                __m256i swapped = _mm256_shuffle_epi32(
+                    data,
+                    _MM_SHUFFLE(1, 0, 3, 2)
+                );
+                a[i] = _mm256_add_epi64(
+                    a[i],
+                    _mm256_add_epi64(product, swapped)
+                );
+            }
+        }
+
+        for (size_t i = 0; i < 2; i += 1) {
+            __m256i key = _mm256_loadu_si256(
+                (const __m256i *)(secret + AVEN_HASH_SECRET_SCRAMBLE + 4 * i)
+            );
+            __m256i x = _mm256_xor_si256(a[i], _mm256_srli_epi64(a[i], 47));
+            x = _mm256_xor_si256(x, key);
+            __m256i x_hi = _mm256_shuffle_epi32(x, _MM_SHUFFLE(0, 3, 0, 1));
+            __m256i product_lo = _mm256_mul_epu32(x, prime);
+            __m256i product_hi = _mm256_mul_epu32(x_hi, prime);
+            a[i] = _mm256_add_epi64(
+                product_lo,
+                _mm256_slli_epi64(product_hi, 32)
+            );
+        }
+
+        p += AVEN_HASH_BLOCK_LEN;
+    }
+
+    for (size_t i = 0; i < 2; i += 1) {
+        _mm256_storeu_si256((__m256i *)(acc + 4 * i), a[i]);
+    }
+}
+#endif
+
+AVEN_FN bool aven_hash_impl_supported(AvenHashImpl impl) {
+    switch (impl) {
+        case AVEN_HASH_IMPL_AUTO:
+        case AVEN_HASH_IMPL_SCALAR:
+            return true;
+        case AVEN_HASH_IMPL_SSE2:
+#ifdef AVEN_HASH_SSE2
+            return true;
+#else
+            return false;
+#endif
+        case AVEN_HASH_IMPL_AVX2:
+#if defined(__AVX2__)
+            return true;
+#elif defined(AVEN_HASH_AVX2)
+            return __builtin_cpu_supports("avx2");
+#else
+            return false;
+#endif
+        default:
+            return false;
+    }
+}
+
+static void aven_hash_blocks(
+    AvenHashImpl impl,
+    uint64_t acc[8],
+    const unsigned char *p,
+    size_t nblocks,
+    const uint64_t *secret
+) {
+    if (impl == AVEN_HASH_IMPL_AUTO) {
+        if (aven_hash_impl_supported(AVEN_HASH_IMPL_AVX2)) {
+            impl = AVEN_HASH_IMPL_AVX2;
+        } else if (aven_hash_impl_supported(AVEN_HASH_IMPL_SSE2)) {
+            impl = AVEN_HASH_IMPL_SSE2;
+        } else {
+            impl = AVEN_HASH_IMPL_SCALAR;
+        }
+    }
+    assert(aven_hash_impl_supported(impl));
+
+    switch (impl) {
+#ifdef AVEN_HASH_AVX2
+        case AVEN_HASH_IMPL_AVX2:
+            aven_hash_blocks_avx2(acc, p, nblocks, secret);
+            break;
+#endif
+#ifdef AVEN_HASH_SSE2
+        case AVEN_HASH_IMPL_SSE2:
+            aven_hash_blocks_sse2(acc, p, nblocks, secret);
+            break;
+#endif
+        default:
+            aven_hash_blocks_scalar(acc, p, nblocks, secret);
+            break;
+    }
+}
+
+static void aven_hash_acc_init(uint64_t acc[8]) {
+    acc[0] = AVEN_HASH_PRIME32_3;
+    acc[1] = AVEN_HASH_PRIME64_1;
+    acc[2] = AVEN_HASH_PRIME64_2;
+    acc[3] = AVEN_HASH_PRIME64_3;
+    acc[4] = AVEN_HASH_PRIME64_4;
+    acc[5] = AVEN_HASH_PRIME32_2;
+    acc[6] = AVEN_HASH_PRIME64_5;
+    acc[7] = AVEN_HASH_PRIME32_1;
+}
+
+static uint64_t aven_hash_merge(
+    const uint64_t acc[8],
+    const uint64_t *key,
+    uint64_t h
+) {
+    for (size_t i = 0; i < 4; i += 1) {
+        h += aven_hash_mul128_fold64(
+            acc[2 * i] ^ key[2 * i],
+            acc[2 * i + 1] ^ key[2 * i + 1]
+        );
+    }
+    return aven_hash_avalanche(h);
+}
+
+// Consumes the stripes remaining after the last full block (end points past
+// the last byte of input), then folds the lanes into the final hash
+static AvenHash aven_hash_finish(
+    uint64_t acc[8],
+    const unsigned char *p,
+    const unsigned char *end,
+    uint64_t total_len,
+    const uint64_t *secret
+) {
+    size_t nstripes = (size_t)(end - p - 1) / AVEN_HASH_STRIPE_LEN;
+    for (size_t s = 0; s < nstripes; s += 1) {
+        aven_hash_stripe_scalar(acc, p + AVEN_HASH_STRIPE_LEN * s, secret + s);
+    }
+    aven_hash_stripe_scalar(
+        acc,
+        end - AVEN_HASH_STRIPE_LEN,
+        secret + AVEN_HASH_SECRET_LAST_STRIPE
+    );
+
+    return (AvenHash){
+        .lo = aven_hash_merge(
+            acc,
+            secret + AVEN_HASH_SECRET_MERGE_LO,
+            total_len * AVEN_HASH_PRIME64_1
+        ),
+        .hi = aven_hash_merge(
+            acc,
+            secret + AVEN_HASH_SECRET_MERGE_HI,
+            ~(total_len * AVEN_HASH_PRIME64_2)
+        ),
+    };
+}
+
+static void aven_hash_secret_init(
+    uint64_t secret[AVEN_HASH_SECRET_WORDS],
+    uint64_t seed
+) {
+    for (size_t i = 0; i < AVEN_HASH_SECRET_WORDS; i += 1) {
+        secret[i] = aven_hash_key(seed, i);
+    }
+}
+
+AVEN_FN AvenHash aven_hash(ByteSlice bytes, uint64_t seed) {
+    if (bytes.len <= AVEN_HASH_SHORT_MAX) {
+        return aven_hash_short(bytes.ptr, bytes.len, seed);
+    }
+
+    uint64_t secret[AVEN_HASH_SECRET_WORDS];
+    aven_hash_secret_init(secret, seed);
+
+    uint64_t acc[8];
+    aven_hash_acc_init(acc);
+
+    size_t nblocks = (bytes.len - 1) / AVEN_HASH_BLOCK_LEN;
+    aven_hash_blocks(AVEN_HASH_IMPL_AUTO, acc, bytes.ptr, nblocks, secret);
+
+    return aven_hash_finish(
+        acc,
+        bytes.ptr + nblocks * AVEN_HASH_BLOCK_LEN,
+        bytes.ptr + bytes.len,
+        bytes.len,
+        secret
+    );
+}
+
+AVEN_FN AvenHashState aven_hash_init(uint64_t seed) {
+    AvenHashState state = { .seed = seed };
+    aven_hash_secret_init(state.secret, seed);
+    aven_hash_acc_init(state.acc);
+    return state;
+}
+
+AVEN_FN void aven_hash_update(AvenHashState *state, ByteSlice bytes) {
+    unsigned char *pending = state->buffer + AVEN_HASH_STRIPE_LEN;
+    const unsigned char *p = bytes.ptr;
+    size_t len = bytes.len;
+
+    assert(state->buffer_len <= AVEN_HASH_BLOCK_LEN);
+    state->total_len += len;
+
+    size_t fill = min(len, AVEN_HASH_BLOCK_LEN - state->buffer_len);
+    if (fill > 0) {
+        memcpy(pending + state->buffer_len, p, fill);
+        state->buffer_len += fill;
+        p += fill;
+        len -= fill;
+    }
+
+    // Input is only consumed once more input follows it, so that the final
+    // (partial) block is always left for aven_hash_digest
+    if (len == 0) {
+        return;
+    }
+
+    aven_hash_blocks(state->impl, state->acc, pending, 1, state->secret);
+    memcpy(
+        state->buffer,
+        pending + AVEN_HASH_BLOCK_LEN - AVEN_HASH_STRIPE_LEN,
+        AVEN_HASH_STRIPE_LEN
+    );
+
+    if (len > AVEN_HASH_BLOCK_LEN) {
+        size_t nblocks = (len - 1) / AVEN_HASH_BLOCK_LEN;
+        aven_hash_blocks(state->impl, state->acc, p, nblocks, state->secret);
+        p += nblocks * AVEN_HASH_BLOCK_LEN;
+        len -= nblocks * AVEN_HASH_BLOCK_LEN;
+        memcpy(state->buffer, p - AVEN_HASH_STRIPE_LEN, AVEN_HASH_STRIPE_LEN);
+    }
+
+    memcpy(pending, p, len);
+    state->buffer_len = len;
+}
+
+AVEN_FN AvenHash aven_hash_digest(AvenHashState *state) {
+    unsigned char *pending = state->buffer + AVEN_HASH_STRIPE_LEN;
+    if (state->total_len <= AVEN_HASH_SHORT_MAX) {
+        return aven_hash_short(pending, state->buffer_len, state->seed);
+    }
+
+    // The final stripe may reach back into the previously consumed input
+    uint64_t acc[8];
+    memcpy(acc, state->acc, sizeof(acc));
+    return aven_hash_finish(
+        acc,
+        pending,
+        pending + state->buffer_len,
+        state->total_len,
+        state->secret
+    );
+}
+
+#endif // AVEN_IMPLEMENTATION
+
+#endif // AVEN_HASH_H
@@ -5,7 +5,6 @@
 #include "arena.h"
 #include "str.h"
 
-#define AVEN_PATH_MAX_ARGS 32
 #define AVEN_PATH_MAX_LEN 4096
 
 #ifdef _WIN32
@@ -14,22 +13,54 @@
     #define AVEN_PATH_SEP '/'
 #endif
 
+typedef Result(AvenStr) AvenPathResult;
+
+// Joins the NULL terminated list of components with AVEN_PATH_SEP
 AVEN_FN AvenStr aven_path(AvenArena *arena, char *path_str, ...);
+// Joins the components with AVEN_PATH_SEP into one NUL terminated string,
+// with a single allocation of the exact length
+AVEN_FN AvenStr aven_path_join_slice(AvenStrSlice parts, AvenArena *arena);
+
+typedef enum {
+    AVEN_PATH_JOIN_ERROR_NONE = 0,
+    AVEN_PATH_JOIN_ERROR_SPACE,
+} AvenPathJoinError;
+
+// Like aven_path_join_slice, but writes the NUL terminated path into buffer,
+// e.g. for temporary paths that are only passed to a system call
+AVEN_FN AvenPathResult aven_path_join_buffer(
+    AvenStrSlice parts,
+    char *buffer,
+    size_t buffer_len
+);
 AVEN_FN AvenStr aven_path_rel_dir(AvenStr path, AvenArena *arena);
 AVEN_FN AvenStr aven_path_fname(AvenStr path, AvenArena *arena);
 AVEN_FN bool aven_path_is_abs(AvenStr path);
+// Collapses "." components, repeated and trailing separators, and ".."
+// components that follow a named component in one forward pass, so equal
+// paths compare equal. Leading ".." components of a relative path are kept,
+// and ".." above an absolute root is dropped. Symbolic links are not
+// resolved. Writes the NUL terminated result to dst, which needs
+// path.len + 1 bytes and may be path.ptr to normalize in place. A path that
+// collapses to nothing becomes ".", and an empty path stays empty.
+AVEN_FN AvenStr aven_path_normalize(AvenStr path, char *dst);
+// Returns the next non-empty component of path, start with *index = 0
+AVEN_FN AvenStrOptional aven_path_next(AvenStr path, size_t *index);
+// The components shared by the start of both paths, joined with single
+// separators. Only the result is allocated.
 AVEN_FN AvenStr aven_path_rel_intersect(
     AvenStr path1,
     AvenStr path2,
     AvenArena *arena
 );
+// The relative path from the directory path2 to path1, e.g. "./../a" from
+// "b" to "a". Only the result is allocated.
 AVEN_FN AvenStr aven_path_rel_diff(
     AvenStr path1,
     AvenStr path2,
     AvenArena *arena
 );
 
-typedef Result(AvenStr) AvenPathResult;
 typedef enum {
     AVEN_PATH_EXE_ERROR_NONE = 0,
     AVEN_PATH_EXE_ERROR_FAIL,
@@ -41,6 +72,7 @@ AVEN_FN AvenPathResult aven_path_exe(AvenArena *arena);
 #ifdef AVEN_IMPLEMENTATION
 
 #include <stdarg.h>
+#include <string.h>
 
 #ifdef __linux__
     #if !defined(_POSIX_C_SOURCE) or _POSIX_C_SOURCE < 200112L
@@ -49,30 +81,103 @@ AVEN_FN AvenPathResult aven_path_exe(AvenArena *arena);
     #include <unistd.h>
 #endif
 
+// Both aven_path and aven_path_join_slice follow aven_str_join: empty
+// components are skipped, but a separator still follows every non-empty
+// component other than the last
 AVEN_FN AvenStr aven_path(AvenArena *arena, char *path_str, ...) {
-    AvenStr path_data[AVEN_PATH_MAX_ARGS];
-    AvenStrSlice path = { .len = 0, .ptr = path_data };
-
-    path_data[0] = aven_str_cstr(path_str);
-    path.len += 1;
-
     va_list args;
     va_start(args, path_str);
+    va_list len_args;
+    va_copy(len_args, args);
+
+    size_t len = 0;
     for (
-        char *cstr = va_arg(args, char *);
+        char *cstr = path_str;
         cstr != NULL;
-        cstr = va_arg(args, char *)
+        cstr = va_arg(len_args, char *)
     ) {
-        path_data[path.len] = aven_str_cstr(cstr);
-        path.len += 1;
+        len += strlen(cstr) + 1;
+    }
+    va_end(len_args);
+
+    AvenStr path = { 0 };
+    path.ptr = aven_arena_alloc(arena, len, 1);
+
+    char *dst = path.ptr;
+    char *cstr = path_str;
+    while (cstr != NULL) {
+        char *next = va_arg(args, char *);
+        size_t cstr_len = strlen(cstr);
+        if (cstr_len > 0) {
+            memcpy(dst, cstr, cstr_len);
+            dst += cstr_len;
+            if (next != NULL) {
+                *dst = AVEN_PATH_SEP;
+                dst += 1;
+            }
+        }
+        cstr = next;
     }
     va_end(args);
 
-    return aven_str_join(
-        path,
-        AVEN_PATH_SEP,
-        arena
-    );
+    path.len = (size_t)(dst - path.ptr);
+    *dst = 0;
+
+    return path;
+}
+
+static size_t aven_path_join_len(AvenStrSlice parts) {
+    size_t len = 0;
+    for (size_t i = 0; i < parts.len; i += 1) {
+        size_t part_len = slice_get(parts, i).len;
+        if (part_len == 0) {
+            continue;
+        }
+
+        len += part_len;
+        if ((i + 1) < parts.len) {
+            len += 1;
+        }
+    }
+    return len;
+}
+
+static void aven_path_join_copy(AvenStrSlice parts, char *dst) {
+    for (size_t i = 0; i < parts.len; i += 1) {
+        AvenStr part = slice_get(parts, i);
+        if (part.len == 0) {
+            continue;
+        }
+
+        memcpy(dst, part.ptr, part.len);
+        dst += part.len;
+        if ((i + 1) < parts.len) {
+            *dst = AVEN_PATH_SEP;
+            dst += 1;
+        }
+    }
+    *dst = 0;
+}
+
+AVEN_FN AvenStr aven_path_join_slice(AvenStrSlice parts, AvenArena *arena) {
+    AvenStr path = { .len = aven_path_join_len(parts) };
+    path.ptr = aven_arena_alloc(arena, path.len + 1, 1);
+    aven_path_join_copy(parts, path.ptr);
+    return path;
+}
+
+AVEN_FN AvenPathResult aven_path_join_buffer(
+    AvenStrSlice parts,
+    char *buffer,
+    size_t buffer_len
+) {
+    size_t len = aven_path_join_len(parts);
+    if (len >= buffer_len) {
+        return (AvenPathResult){ .error = AVEN_PATH_JOIN_ERROR_SPACE };
+    }
+
+    aven_path_join_copy(parts, buffer);
+    return (AvenPathResult){ .payload = { .ptr = buffer, .len = len } };
 }
 
 AVEN_FN AvenStr aven_path_fname(AvenStr path, AvenArena *arena) {
@@ -139,6 +244,120 @@ AVEN_FN bool aven_path_is_abs(AvenStr path) {
 #endif
 }
 
+AVEN_FN AvenStr aven_path_normalize(AvenStr path, char *dst) {
+    size_t r = 0;
+    size_t w = 0;
+
+    // Copy the root, which ".." components cannot go above
+#ifdef _WIN32
+    if (path.len >= 2 and path.ptr[1] == ':') {
+        dst[0] = path.ptr[0];
+        dst[1] = ':';
+        r = 2;
+        w = 2;
+    } else if (
+        path.len >= 2 and
+        path.ptr[0] == AVEN_PATH_SEP and
+        path.ptr[1] == AVEN_PATH_SEP
+    ) {
+        dst[0] = AVEN_PATH_SEP;
+        dst[1] = AVEN_PATH_SEP;
+        r = 2;
+        w = 2;
+    }
+#endif
+    if (
+        r < path.len and
+        path.ptr[r] == AVEN_PATH_SEP and
+        (w == 0 or dst[w - 1] == ':')
+    ) {
+        dst[w] = AVEN_PATH_SEP;
+        w += 1;
+    }
+    size_t root_len = w;
+    bool is_abs = root_len > 0 and dst[root_len - 1] == AVEN_PATH_SEP;
+
+    // Output before base_len is the root and any leading ".." components
+    size_t base_len = root_len;
+
+    while (r < path.len) {
+        if (path.ptr[r] == AVEN_PATH_SEP) {
+            r += 1;
+            continue;
+        }
+
+        size_t start = r;
+        while (r < path.len and path.ptr[r] != AVEN_PATH_SEP) {
+            r += 1;
+        }
+        size_t len = r - start;
+
+        if (len == 1 and path.ptr[start] == '.') {
+            continue;
+        }
+
+        bool is_parent = len == 2 and
+            path.ptr[start] == '.' and
+            path.ptr[start + 1] == '.';
+        if (is_parent) {
+            if (w > base_len) {
+                while (w > base_len and dst[w - 1] != AVEN_PATH_SEP) {
+                    w -= 1;
+                }
+                if (w > root_len) {
+                    w -= 1;
+                }
+                continue;
+            }
+            if (is_abs) {
+                continue;
+            }
+        }
+
+        // The output never gets ahead of the input, so in place the
+        // component is only ever moved back
+        if (w > root_len) {
+            dst[w] = AVEN_PATH_SEP;
+            w += 1;
+        }
+        memmove(dst + w, path.ptr + start, len);
+        w += len;
+
+        if (is_parent) {
+            base_len = w;
+        }
+    }
+
+    if (w == 0 and path.len > 0) {
+        dst[0] = '.';
+        w = 1;
+    }
+    dst[w] = 0;
+
+    return (AvenStr){ .ptr = dst, .len = w };
+}
+
+AVEN_FN AvenStrOptional aven_path_next(AvenStr path, size_t *index) {
+    size_t start = *index;
+    while (start < path.len and path.ptr[start] == AVEN_PATH_SEP) {
+        start += 1;
+    }
+    if (start == path.len) {
+        *index = start;
+        return (AvenStrOptional){ 0 };
+    }
+
+    AvenStr rest = { .ptr = path.ptr + start, .len = path.len - start };
+    AvenStrOptionalIndex sep = aven_str_find_char(rest, AVEN_PATH_SEP);
+    AvenStr component = {
+        .ptr = rest.ptr,
+        .len = sep.valid ? sep.value : rest.len,
+    };
+    *index = start + component.len;
+
+    return (AvenStrOptional){ .value = component, .valid = true };
+}
+
 AVEN_FN AvenStr aven_path_rel_intersect(
     AvenStr path1,
     AvenStr path2,
@@ -151,43 +370,62 @@ AVEN_FN AvenStr aven_path_rel_intersect(
         return aven_str("");
     }
 
-    AvenArena temp_arena = *arena;
-
-    AvenStrSlice path1_parts = aven_str_split(
-        path1,
-        AVEN_PATH_SEP,
-        &temp_arena
-    );
-    AvenStrSlice path2_parts = aven_str_split(
-        path2,
-        AVEN_PATH_SEP,
-        &temp_arena
-    );
-
-    size_t len = min(path1_parts.len, path2_parts.len);
-    size_t same_index = 0;
-    for (; same_index < len; same_index += 1) {
-        bool match = aven_str_compare(
-            slice_get(path1_parts, same_index),
-            slice_get(path2_parts, same_index)
-        );
-        if (!match) {
+    // Measure the shared components, then copy them out of path1
+    size_t index1 = 0;
+    size_t index2 = 0;
+    size_t same_count = 0;
+    size_t len = 0;
+    for (;;) {
+        AvenStrOptional part1 = aven_path_next(path1, &index1);
+        AvenStrOptional part2 = aven_path_next(path2, &index2);
+        if (
+            !part1.valid or
+            !part2.valid or
+            !aven_str_compare(part1.value, part2.value)
+        ) {
             break;
         }
+
+        if (same_count > 0) {
+            len += 1;
+        }
+        len += part1.value.len;
+        same_count += 1;
     }
 
-    if (same_index == 0) {
+    if (same_count == 0) {
         return aven_str("");
     }
 
-    path1_parts.len = same_index;
-    AvenStr intersect = aven_str_join(path1_parts, AVEN_PATH_SEP, &temp_arena);
-    
-    *arena = temp_arena;
+    AvenStr intersect = { .len = len };
+    intersect.ptr = aven_arena_alloc(arena, intersect.len + 1, 1);
+
+    char *dst = intersect.ptr;
+    index1 = 0;
+    for (size_t i = 0; i < same_count; i += 1) {
+        AvenStr part = aven_path_next(path1, &index1).value;
+        if (i > 0) {
+            *dst = AVEN_PATH_SEP;
+            dst += 1;
+        }
+        memcpy(dst, part.ptr, part.len);
+        dst += part.len;
+    }
+    *dst = 0;
 
     return intersect;
 }
 
+// Returns the index just past a leading "." component, or 0 without one
+static size_t aven_path_skip_dot(AvenStr path) {
+    size_t index = 0;
+    AvenStrOptional part = aven_path_next(path, &index);
+    if (part.valid and aven_str_compare(part.value, aven_str("."))) {
+        return index;
+    }
+    return 0;
+}
+
 AVEN_FN AvenStr aven_path_rel_diff(
     AvenStr path1,
     AvenStr path2,
@@ -196,59 +434,61 @@ AVEN_FN AvenStr aven_path_rel_diff(
     assert(!aven_path_is_abs(path1));
     assert(!aven_path_is_abs(path2));
 
-    AvenStrSlice path1_parts = aven_str_split(
-        path1,
-        AVEN_PATH_SEP,
-        arena
-    );
-    if (aven_str_compare(slice_get(path1_parts, 0), aven_str("."))) {
-        path1_parts.ptr += 1;
-        path1_parts.len -= 1;
-    }
-
-    AvenStrSlice path2_parts = aven_str_split(
-        path2,
-        AVEN_PATH_SEP,
-        arena
-    );
-    if (
-        path2_parts.len > 0 and
-        aven_str_compare(slice_get(path2_parts, 0), aven_str("."))
-    ) {
-        path2_parts.ptr += 1;
-        path2_parts.len -= 1;
-    }
-
-    size_t len = min(path1_parts.len, path2_parts.len);
-    size_t same_index = 0;
-    for (; same_index < len; same_index += 1) {
-        bool match = aven_str_compare(
-            slice_get(path1_parts, same_index),
-            slice_get(path2_parts, same_index)
-        );
-        if (!match) {
+    // Skip the shared components, keeping the index of the first that
+    // differs in each path
+    size_t index1 = aven_path_skip_dot(path1);
+    size_t index2 = aven_path_skip_dot(path2);
+    for (;;) {
+        size_t next1 = index1;
+        size_t next2 = index2;
+        AvenStrOptional part1 = aven_path_next(path1, &next1);
+        AvenStrOptional part2 = aven_path_next(path2, &next2);
+        if (
+            !part1.valid or
+            !part2.valid or
+            !aven_str_compare(part1.value, part2.value)
+        ) {
             break;
         }
+        index1 = next1;
+        index2 = next2;
     }
 
-    AvenStrSlice diff_parts = {
-        .len = 1 + path1_parts.len + path2_parts.len - 2 * same_index
-    };
-    diff_parts.ptr = aven_arena_create_array(AvenStr, arena, diff_parts.len);
-
-    size_t diff_index = 0;
-    slice_get(diff_parts, diff_index) = aven_str(".");
-    diff_index += 1;
-    for (size_t i = same_index; i < path2_parts.len; i += 1) {
-        slice_get(diff_parts, diff_index) = aven_str("..");
-        diff_index += 1;
+    // The diff is "." followed by a ".." for each component left in path2,
+    // then the components left in path1
+    size_t up_count = 0;
+    size_t up_index = index2;
+    while (aven_path_next(path2, &up_index).valid) {
+        up_count += 1;
+    }
+
+    // The rest of path1 takes at most one byte per remaining byte plus a
+    // separator, so allocate that much and give back what is left over
+    size_t max_len = 1 + 3 * up_count + 1 + (path1.len - index1);
+    char *diff_mem = aven_arena_alloc(arena, max_len + 1, 1);
+
+    char *dst = diff_mem;
+    *dst = '.';
+    dst += 1;
+    for (size_t i = 0; i < up_count; i += 1) {
+        dst[0] = AVEN_PATH_SEP;
+        dst[1] = '.';
+        dst[2] = '.';
+        dst += 3;
     }
-    for (size_t i = same_index; i < path1_parts.len; i += 1) {
-        slice_get(diff_parts, diff_index) = slice_get(path1_parts, i);
-        diff_index += 1;
+    for (
+        AvenStrOptional part = aven_path_next(path1, &index1);
+        part.valid;
+        part = aven_path_next(path1, &index1)
+    ) {
+        *dst = AVEN_PATH_SEP;
+        memcpy(dst + 1, part.value.ptr, part.value.len);
+        dst += 1 + part.value.len;
     }
+    *dst = 0;
 
-    AvenStr diff = aven_str_join(diff_parts, AVEN_PATH_SEP, arena);
+    AvenStr diff = { .ptr = diff_mem, .len = (size_t)(dst - diff_mem) };
+    aven_arena_resize(arena, diff.ptr, max_len + 1, diff.len + 1);
 
     return diff;
 }
@@ -4,6 +4,7 @@
 #include "../aven.h"
 #include "arena.h"
 #include "str.h"
+#include "str/rope.h"
 
 #ifdef _WIN32
     typedef void *AvenProcId;
@@ -60,15 +61,16 @@ AVEN_FN AvenProcIdResult aven_proc_cmd(
     AvenStrSlice cmd,
     AvenArena arena
 ) {
+#ifdef _WIN32
     AvenStr cmd_str = aven_str_join(
         cmd,
         ' ',
         &arena
     );
-#ifndef AVEN_SUPPRESS_LOGS
-    printf("%s\n", cmd_str.ptr);
-#endif
-#ifdef _WIN32
+    #ifndef AVEN_SUPPRESS_LOGS
+        printf("%s\n", cmd_str.ptr);
+    #endif
+
     typedef struct {
         uint32_t len;
         void *security_descriptor;
@@ -147,6 +149,19 @@ AVEN_FN AvenProcIdResult aven_proc_cmd(
     
     return (AvenProcIdResult){ .payload = process_info.process };
 #else
+    // The command line is only needed for logging here, so its pieces are
+    // written out directly rather than joined, which matters for link lines
+    // with thousands of objects
+    #ifndef AVEN_SUPPRESS_LOGS
+        AvenStrRope cmd_rope = { 0 };
+        aven_str_rope_push_join(&cmd_rope, cmd, aven_str(" "), &arena);
+        aven_str_rope_push(&cmd_rope, aven_str("\n"), &arena);
+
+        // Flush first so the line stays in order with buffered output
+        fflush(stdout);
+        aven_str_rope_write(&cmd_rope, STDOUT_FILENO);
+    #endif
+
     AvenProcId cmd_pid = fork();
     if (cmd_pid < 0) {
         return (AvenProcIdResult){ .error = AVEN_PROC_CMD_ERROR_FORK };
@@ -167,7 +182,15 @@ AVEN_FN AvenProcIdResult aven_proc_cmd(
         int error = execvp(slice_get(cmd, 0).ptr, args);
         if (error != 0) {
 #ifndef AVEN_SUPPRESS_LOGS
-            fprintf(stderr, "execvp failed: %s\n", cmd_str.ptr);
+            AvenStrRope error_rope = { 0 };
+            aven_str_rope_push(
+                &error_rope,
+                aven_str("execvp failed: "),
+                &arena
+            );
+            aven_str_rope_push_join(&error_rope, cmd, aven_str(" "), &arena);
+            aven_str_rope_push(&error_rope, aven_str("\n"), &arena);
+            aven_str_rope_write(&error_rope, STDERR_FILENO);
 #endif
             exit(errno);
         }
@@ -6,30 +6,45 @@
 
 typedef Slice(char) AvenStr;
 typedef Slice(AvenStr) AvenStrSlice;
+typedef Optional(size_t) AvenStrOptionalIndex;
+typedef Optional(AvenStr) AvenStrOptional;
 
 #define aven_str(a) (AvenStr){ \
         .ptr = a, \
         .len = sizeof(a) - 1 \
     }
 
+// Byte primitives with AVX2 or SSE2 paths chosen at compile time (AVX2 when
+// built with e.g. -mavx2 or -march=native) and a portable word at a time
+// fallback for other targets, e.g. ARM
+AVEN_FN size_t aven_str_cstr_len(const char *cstr);
+AVEN_FN bool aven_str_mem_eq(const char *s1, const char *s2, size_t len);
+AVEN_FN AvenStrOptionalIndex aven_str_find_char(AvenStr str, char c);
+AVEN_FN size_t aven_str_count_char(AvenStr str, char c);
+// Returns the index of the first or last occurrence of needle in str. The
+// first and last bytes of needle are matched a vector at a time to find
+// candidates, and if verifying candidates gets expensive the search
+// switches to the Two-Way algorithm, so it is linear time for any input.
+// An empty needle matches at 0 and str.len respectively.
+AVEN_FN AvenStrOptionalIndex aven_str_find(AvenStr str, AvenStr needle);
+AVEN_FN AvenStrOptionalIndex aven_str_find_last(AvenStr str, AvenStr needle);
+
 static inline AvenStr aven_str_cstr(char *cstr) {
-    size_t len = 0;
-    for (char *c = cstr; *c != 0; c += 1) {
-        len += 1;
-    }
-    return (AvenStr){ .ptr = cstr, .len = len };
+    return (AvenStr){ .ptr = cstr, .len = aven_str_cstr_len(cstr) };
 }
 
 static inline bool aven_str_compare(AvenStr s1, AvenStr s2) {
-    if (s1.len != s2.len) {
-        return false;
-    }
-    for (size_t i = 0; i < s1.len; i += 1) {
-        if (slice_get(s1, i) != slice_get(s2, i)) {
-            return false;
-        }
-    }
-    return true;
+    return s1.len == s2.len and aven_str_mem_eq(s1.ptr, s2.ptr, s1.len);
+}
+
+static inline bool aven_str_starts_with(AvenStr str, AvenStr prefix) {
+    return str.len >= prefix.len and
+        aven_str_mem_eq(str.ptr, prefix.ptr, prefix.len);
+}
+
+static inline bool aven_str_ends_with(AvenStr str, AvenStr suffix) {
+    return str.len >= suffix.len and
+        aven_str_mem_eq(str.ptr + str.len - suffix.len, suffix.ptr, suffix.len);
 }
 
 static inline AvenStr aven_str_copy(AvenStr str, AvenArena *arena) {
@@ -40,53 +55,61 @@ static inline AvenStr aven_str_copy(AvenStr str, AvenArena *arena) {
     return cpy;
 }
 
-static inline AvenStrSlice aven_str_split(
+// Splits str on separator, skipping empty tokens. The tokens are views into
+// str, so only the slice is allocated, but they are not NUL terminated.
+static inline AvenStrSlice aven_str_split_view(
     AvenStr str,
     char separator,
     AvenArena *arena
 ) {
-    size_t nsep = 0;
-    size_t after_last_sep = 0;
-    for (size_t i = 0; i <= str.len; i += 1) {
-        if (i == str.len or slice_get(str, i) == separator) {
-            if (i - after_last_sep > 0) {
-                nsep += 1;
-            }
-            after_last_sep = i + 1;
-        }
-    }
+    // Empty tokens are skipped, so this is an upper bound on the count
+    size_t max_tokens = aven_str_count_char(str, separator) + 1;
 
     AvenStr *split_mem = aven_arena_create_array(
         AvenStr,
         arena,
-        nsep
+        max_tokens
     );
 
     AvenStrSlice split_strs = {
         .ptr = split_mem,
-        .len = nsep,
+        .len = 0,
     };
 
-    size_t string_index = 0;
-    after_last_sep = 0;
-    for (size_t i = 0; i <= str.len; i += 1) {
-        if (i == str.len or slice_get(str, i) == separator) {
-            size_t len = i - after_last_sep;
-            if (len > 0) {
-                char *string_mem = aven_arena_alloc(arena, len + 1, 1);
-
-                slice_get(split_strs, string_index) = (AvenStr){
-                    .ptr = string_mem,
-                    .len = len,
-                };
-                memcpy(string_mem, str.ptr + after_last_sep, len);
-                string_mem[len] = 0;
-
-                string_index += 1;
-            }
+    AvenStr rest = str;
+    for (;;) {
+        AvenStrOptionalIndex sep = aven_str_find_char(rest, separator);
+        size_t len = sep.valid ? sep.value : rest.len;
+        if (len > 0) {
+            split_strs.ptr[split_strs.len] = (AvenStr){
+                .ptr = rest.ptr,
+                .len = len,
+            };
+            split_strs.len += 1;
+        }
 
-            after_last_sep = i + 1;
+        if (!sep.valid) {
+            break;
         }
+        rest.ptr += len + 1;
+        rest.len -= len + 1;
+    }
+
+    return split_strs;
+}
+
+// Like aven_str_split_view, but each token is a NUL terminated copy
+static inline AvenStrSlice aven_str_split(
+    AvenStr str,
+    char separator,
+    AvenArena *arena
+) {
+    AvenStrSlice split_strs = aven_str_split_view(str, separator, arena);
+    for (size_t i = 0; i < split_strs.len; i += 1) {
+        slice_get(split_strs, i) = aven_str_copy(
+            slice_get(split_strs, i),
+            arena
+        );
     }
 
     return split_strs;
@@ -173,4 +196,1192 @@ static inline AvenStr aven_str_join(
     return new_str;
 }
 
+typedef enum {
+    AVEN_STR_TOKENIZER_TYPE_CHAR = 0,
+    AVEN_STR_TOKENIZER_TYPE_SET,
+} AvenStrTokenizerType;
+
+// A lazy tokenizer over a string, next returns views of the non-empty tokens
+// one at a time without allocating, e.g. for streaming over large files
+typedef struct {
+    AvenStr rest;
+    AvenStrTokenizerType type;
+    char separator;
+    uint64_t set[4];
+} AvenStrTokenizer;
+
+// Splits on a single separator character
+AVEN_FN AvenStrTokenizer aven_str_tokenizer(AvenStr str, char separator);
+// Splits on any of the characters in separators
+AVEN_FN AvenStrTokenizer aven_str_tokenizer_set(
+    AvenStr str,
+    AvenStr separators
+);
+// Splits on ASCII whitespace
+AVEN_FN AvenStrTokenizer aven_str_tokenizer_space(AvenStr str);
+AVEN_FN AvenStrOptional aven_str_tokenizer_next(AvenStrTokenizer *tokenizer);
+
+typedef Optional(uint32_t) AvenStrOptionalCodepoint;
+
+// Checks that str is well formed UTF-8, rejecting overlong encodings,
+// surrogates, and code points past U+10FFFF. With AVX2 (chosen at run time
+// with GCC or clang on x86) this is the lookup table algorithm of Keiser and
+// Lemire, 32 bytes at a time; otherwise ASCII runs are skipped a vector or
+// word at a time and the rest is decoded.
+AVEN_FN bool aven_str_utf8_valid(AvenStr str);
+// Decodes the code point at *index and advances past it, start with
+// *index = 0. Ill-formed sequences decode to U+FFFD and advance by their
+// longest valid prefix (at least one byte), as the Unicode standard
+// recommends, so arbitrary bytes can be displayed.
+AVEN_FN AvenStrOptionalCodepoint aven_str_utf8_next(AvenStr str, size_t *index);
+// Terminal column width of a code point: 0 for controls and combining
+// marks, 2 for East Asian wide and fullwidth characters and emoji, else 1
+AVEN_FN size_t aven_str_utf8_width(uint32_t codepoint);
+// Returns the longest prefix of str that fits in width terminal columns
+// without splitting a code point, keeping any trailing combining marks
+AVEN_FN AvenStr aven_str_utf8_truncate(AvenStr str, size_t width);
+
+#ifdef AVEN_IMPLEMENTATION
+
+#include <string.h>
+
+#if defined(__SSE2__) or defined(_M_X64) or \
+    (defined(_M_IX86_FP) and _M_IX86_FP >= 2)
+    #define AVEN_STR_SSE2
+    #include <emmintrin.h>
+#endif
+
+#if defined(AVEN_STR_SSE2) and defined(__AVX2__)
+    #define AVEN_STR_AVX2
+    #include <immintrin.h>
+#endif
+
+// UTF-8 validation gains the most from AVX2, so with GCC or clang it is also
+// compiled for AVX2 and selected at run time when not built with -mavx2
+#if defined(AVEN_STR_SSE2) and ( \
+        defined(__AVX2__) or ( \
+            (defined(__GNUC__) or defined(__clang__)) and \
+            (defined(__x86_64__) or defined(__i386__)) \
+        ) \
+    )
+    #define AVEN_STR_UTF8_AVX2
+    #include <immintrin.h>
+    #ifdef __AVX2__
+        #define AVEN_STR_UTF8_AVX2_FN static
+    #else
+        #define AVEN_STR_UTF8_AVX2_FN static __attribute__((target("avx2")))
+    #endif
+#endif
+
+#if defined(_MSC_VER) and !defined(__clang__)
+    #include <intrin.h>
+#endif
+
+// Reading past the terminator is safe within an aligned vector or word, since
+// it cannot cross a page, but address sanitizer would still report it
+#if __has_attribute(no_sanitize_address)
+    #define AVEN_STR_NO_ASAN __attribute__((no_sanitize_address))
+#else
+    #define AVEN_STR_NO_ASAN
+#endif
+
+#define AVEN_STR_SWAR_ONES 0x0101010101010101ULL
+#define AVEN_STR_SWAR_LOW7 0x7f7f7f7f7f7f7f7fULL
+
+static inline uint32_t aven_str_ctz(uint32_t x) {
+    assert(x != 0);
+#if defined(__GNUC__) or defined(__clang__)
+    return (uint32_t)__builtin_ctz(x);
+#elif defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward(&index, x);
+    return (uint32_t)index;
+#else
+    uint32_t n = 0;
+    for (; (x & 1) == 0; x >>= 1) {
+        n += 1;
+    }
+    return n;
+#endif
+}
+
+// Index of the highest set bit
+static inline uint32_t aven_str_bsr(uint32_t x) {
+    assert(x != 0);
+#if defined(__GNUC__) or defined(__clang__)
+    return 31 - (uint32_t)__builtin_clz(x);
+#elif defined(_MSC_VER)
+    unsigned long index;
+    _BitScanReverse(&index, x);
+    return (uint32_t)index;
+#else
+    uint32_t n = 0;
+    for (; x > 1; x >>= 1) {
+        n += 1;
+    }
+    return n;
+#endif
+}
+
+static inline uint64_t aven_str_load64(const char *ptr) {
+    uint64_t word;
+    memcpy(&word, ptr, sizeof(word));
+    return word;
+}
+
+#if !defined(AVEN_STR_SSE2)
+    // Plain loads rather than memcpy, which sanitizers intercept and check
+    #if __has_attribute(may_alias)
+        typedef uint64_t __attribute__((may_alias)) AvenStrWordAlias;
+
+        AVEN_STR_NO_ASAN static inline uint64_t aven_str_load64_aligned(
+            const char *ptr
+        ) {
+            return *(const AvenStrWordAlias *)ptr;
+        }
+    #else
+        static inline uint64_t aven_str_load64_aligned(const char *ptr) {
+            return aven_str_load64(ptr);
+        }
+    #endif
+#endif
+
+// Sets the high bit of exactly the zero bytes of x
+static inline uint64_t aven_str_swar_zeros(uint64_t x) {
+    return ~(((x & AVEN_STR_SWAR_LOW7) + AVEN_STR_SWAR_LOW7) | x |
+        AVEN_STR_SWAR_LOW7);
+}
+
+AVEN_STR_NO_ASAN AVEN_FN size_t aven_str_cstr_len(const char *cstr) {
+#if defined(AVEN_STR_AVX2)
+    uintptr_t offset = (uintptr_t)cstr & 31;
+    const char *ptr = cstr - offset;
+    __m256i zero = _mm256_setzero_si256();
+    __m256i chunk = _mm256_load_si256((const __m256i *)ptr);
+    uint32_t mask = (uint32_t)_mm256_movemask_epi8(
+        _mm256_cmpeq_epi8(chunk, zero)
+    );
+    mask >>= offset;
+    if (mask != 0) {
+        return aven_str_ctz(mask);
+    }
+    for (;;) {
+        ptr += 32;
+        chunk = _mm256_load_si256((const __m256i *)ptr);
+        mask = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, zero));
+        if (mask != 0) {
+            return (size_t)(ptr - cstr) + aven_str_ctz(mask);
+        }
+    }
+#elif defined(AVEN_STR_SSE2)
+    uintptr_t offset = (uintptr_t)cstr & 15;
+    const char *ptr = cstr - offset;
+    __m128i zero = _mm_setzero_si128();
+    __m128i chunk = _mm_load_si128((const __m128i *)ptr);
+    uint32_t mask = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, zero));
+    mask >>= offset;
+    if (mask != 0) {
+        return aven_str_ctz(mask);
+    }
+    for (;;) {
+        ptr += 16;
+        chunk = _mm_load_si128((const __m128i *)ptr);
+        mask = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, zero));
+        if (mask != 0) {
+            return (size_t)(ptr - cstr) + aven_str_ctz(mask);
+        }
+    }
+#else
+    const char *ptr = cstr;
+    for (; ((uintptr_t)ptr & 7) != 0; ptr += 1) {
+        if (*ptr == 0) {
+            return (size_t)(ptr - cstr);
+        }
+    }
+    while (aven_str_swar_zeros(aven_str_load64_aligned(ptr)) == 0) {
+        ptr += 8;
+    }
+    while (*ptr != 0) {
+        ptr += 1;
+    }
+    return (size_t)(ptr - cstr);
+#endif
+}
+
+AVEN_FN bool aven_str_mem_eq(const char *s1, const char *s2, size_t len) {
+    size_t i = 0;
+#ifdef AVEN_STR_AVX2
+    for (; len - i >= 32; i += 32) {
+        __m256i c1 = _mm256_loadu_si256((const __m256i *)(s1 + i));
+        __m256i c2 = _mm256_loadu_si256((const __m256i *)(s2 + i));
+        uint32_t mask = (uint32_t)_mm256_movemask_epi8(
+            _mm256_cmpeq_epi8(c1, c2)
+        );
+        if (mask != 0xffffffffU) {
+            return false;
+        }
+    }
+#endif
+#ifdef AVEN_STR_SSE2
+    for (; len - i >= 16; i += 16) {
+        __m128i c1 = _mm_loadu_si128((const __m128i *)(s1 + i));
+        __m128i c2 = _mm_loadu_si128((const __m128i *)(s2 + i));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(c1, c2)) != 0xffff) {
+            return false;
+        }
+    }
+#endif
+    for (; len - i >= 8; i += 8) {
+        if (aven_str_load64(s1 + i) != aven_str_load64(s2 + i)) {
+            return false;
+        }
+    }
+    for (; i < len; i += 1) {
+        if (s1[i] != s2[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+AVEN_FN AvenStrOptionalIndex aven_str_find_char(AvenStr str, char c) {
+    size_t i = 0;
+#ifdef AVEN_STR_AVX2
+    __m256i c256 = _mm256_set1_epi8(c);
+    for (; str.len - i >= 32; i += 32) {
+        __m256i chunk = _mm256_loadu_si256((const __m256i *)(str.ptr + i));
+        uint32_t mask = (uint32_t)_mm256_movemask_epi8(
+            _mm256_cmpeq_epi8(chunk, c256)
+        );
+        if (mask != 0) {
+            return (AvenStrOptionalIndex){
+                .value = i + aven_str_ctz(mask),
+                .valid = true,
+            };
+        }
+    }
+#endif
+#ifdef AVEN_STR_SSE2
+    __m128i c128 = _mm_set1_epi8(c);
+    for (; str.len - i >= 16; i += 16) {
+        __m128i chunk = _mm_loadu_si128((const __m128i *)(str.ptr + i));
+        uint32_t mask = (uint32_t)_mm_movemask_epi8(
+            _mm_cmpeq_epi8(chunk, c128)
+        );
+        if (mask != 0) {
+            return (AvenStrOptionalIndex){
+                .value = i + aven_str_ctz(mask),
+                .valid = true,
+            };
+        }
+    }
+#endif
+    uint64_t pattern = AVEN_STR_SWAR_ONES * (unsigned char)c;
+    for (; str.len - i >= 8; i += 8) {
+        uint64_t word = aven_str_load64(str.ptr + i) ^ pattern;
+        if (aven_str_swar_zeros(word) != 0) {
+            break;
+        }
+    }
+    for (; i < str.len; i += 1) {
+        if (str.ptr[i] == c) {
+            return (AvenStrOptionalIndex){ .value = i, .valid = true };
+        }
+    }
+    return (AvenStrOptionalIndex){ 0 };
+}
+
+AVEN_FN size_t aven_str_count_char(AvenStr str, char c) {
+    size_t count = 0;
+    size_t i = 0;
+#ifdef AVEN_STR_AVX2
+    __m256i c256 = _mm256_set1_epi8(c);
+    __m256i zero256 = _mm256_setzero_si256();
+    while (str.len - i >= 32) {
+        // Byte counters are flushed before they can overflow
+        size_t nchunks = min((str.len - i) / 32, (size_t)255);
+        __m256i counts = zero256;
+        for (size_t j = 0; j < nchunks; j += 1) {
+            __m256i chunk = _mm256_loadu_si256(
+                (const __m256i *)(str.ptr + i)
+            );
+            counts = _mm256_sub_epi8(counts, _mm256_cmpeq_epi8(chunk, c256));
+            i += 32;
+        }
+
+        uint64_t sums[4];
+        _mm256_storeu_si256(
+            (__m256i *)sums,
+            _mm256_sad_epu8(counts, zero256)
+        );
+        count += (size_t)(sums[0] + sums[1] + sums[2] + sums[3]);
+    }
+#endif
+#ifdef AVEN_STR_SSE2
+    __m128i c128 = _mm_set1_epi8(c);
+    __m128i zero128 = _mm_setzero_si128();
+    while (str.len - i >= 16) {
+        size_t nchunks = min((str.len - i) / 16, (size_t)255);
+        __m128i counts = zero128;
+        for (size_t j = 0; j < nchunks; j += 1) {
+            __m128i chunk = _mm_loadu_si128((const __m128i *)(str.ptr + i));
+            counts = _mm_sub_epi8(counts, _mm_cmpeq_epi8(chunk, c128));
+            i += 16;
+        }
+
+        uint64_t sums[2];
+        _mm_storeu_si128((__m128i *)sums, _mm_sad_epu8(counts, zero128));
+        count += (size_t)(sums[0] + sums[1]);
+    }
+#endif
+    uint64_t pattern = AVEN_STR_SWAR_ONES * (unsigned char)c;
+    for (; str.len - i >= 8; i += 8) {
+        uint64_t word = aven_str_load64(str.ptr + i) ^ pattern;
+        uint64_t matches = aven_str_swar_zeros(word) >> 7;
+        count += (size_t)((matches * AVEN_STR_SWAR_ONES) >> 56);
+    }
+    for (; i < str.len; i += 1) {
+        if (str.ptr[i] == c) {
+            count += 1;
+        }
+    }
+    return count;
+}
+
+// Bit i is set if the byte at ptr + i equals first and the byte at
+// ptr + i + last equals last_c, for AVEN_STR_FIND_BLOCK consecutive i
+#if defined(AVEN_STR_AVX2)
+    #define AVEN_STR_FIND_BLOCK 32
+
+    static inline uint32_t aven_str_find_block(
+        const char *ptr,
+        size_t last,
+        char first_c,
+        char last_c
+    ) {
+        __m256i first = _mm256_loadu_si256((const __m256i *)ptr);
+        __m256i end = _mm256_loadu_si256((const __m256i *)(ptr + last));
+        __m256i match = _mm256_and_si256(
+            _mm256_cmpeq_epi8(first, _mm256_set1_epi8(first_c)),
+            _mm256_cmpeq_epi8(end, _mm256_set1_epi8(last_c))
+        );
+        return (uint32_t)_mm256_movemask_epi8(match);
+    }
+#elif defined(AVEN_STR_SSE2)
+    #define AVEN_STR_FIND_BLOCK 16
+
+    static inline uint32_t aven_str_find_block(
+        const char *ptr,
+        size_t last,
+        char first_c,
+        char last_c
+    ) {
+        __m128i first = _mm_loadu_si128((const __m128i *)ptr);
+        __m128i end = _mm_loadu_si128((const __m128i *)(ptr + last));
+        __m128i match = _mm_and_si128(
+            _mm_cmpeq_epi8(first, _mm_set1_epi8(first_c)),
+            _mm_cmpeq_epi8(end, _mm_set1_epi8(last_c))
+        );
+        return (uint32_t)_mm_movemask_epi8(match);
+    }
+#else
+    #define AVEN_STR_FIND_BLOCK 8
+
+    static inline uint32_t aven_str_find_block(
+        const char *ptr,
+        size_t last,
+        char first_c,
+        char last_c
+    ) {
+        uint64_t first = aven_str_load64(ptr) ^
+            (AVEN_STR_SWAR_ONES * (unsigned char)first_c);
+        uint64_t end = aven_str_load64(ptr + last) ^
+            (AVEN_STR_SWAR_ONES * (unsigned char)last_c);
+        uint64_t match = aven_str_swar_zeros(first) & aven_str_swar_zeros(end);
+        // Gather the high bit of each byte into the low byte, in order
+        return (uint32_t)((match * 0x0002040810204081ULL) >> 56);
+    }
+#endif
+
+// A needle or haystack for Two-Way, optionally read back to front so the
+// same code finds the last occurrence
+typedef struct {
+    const unsigned char *ptr;
+    ptrdiff_t len;
+    bool reverse;
+} AvenStrTwoWayView;
+
+static inline unsigned char aven_str_two_way_at(
+    AvenStrTwoWayView view,
+    ptrdiff_t i
+) {
+    return view.reverse ? view.ptr[view.len - 1 - i] : view.ptr[i];
+}
+
+// Returns the start of the maximal suffix of needle for the byte order, or
+// the reversed order if flip, minus one, and sets its period
+static ptrdiff_t aven_str_two_way_max_suffix(
+    AvenStrTwoWayView needle,
+    bool flip,
+    ptrdiff_t *period
+) {
+    ptrdiff_t ms = -1;
+    ptrdiff_t j = 0;
+    ptrdiff_t k = 1;
+    ptrdiff_t p = 1;
+    while (j + k < needle.len) {
+        unsigned char a = aven_str_two_way_at(needle, j + k);
+        unsigned char b = aven_str_two_way_at(needle, ms + k);
+        if (flip ? a > b : a < b) {
+            j += k;
+            k = 1;
+            p = j - ms;
+        } else if (a == b) {
+            if (k != p) {
+                k += 1;
+            } else {
+                j += p;
+                k = 1;
+            }
+        } else {
+            ms = j;
+            j = ms + 1;
+            k = 1;
+            p = 1;
+        }
+    }
+    *period = p;
+    return ms;
+}
+
+// The Two-Way algorithm of Crochemore and Perrin: linear time and constant
+// space, returning the offset of the first match in view order
+static AvenStrOptionalIndex aven_str_two_way(
+    AvenStrTwoWayView hay,
+    AvenStrTwoWayView needle
+) {
+    ptrdiff_t m = needle.len;
+    ptrdiff_t p;
+    ptrdiff_t q;
+    ptrdiff_t i = aven_str_two_way_max_suffix(needle, false, &p);
+    ptrdiff_t j = aven_str_two_way_max_suffix(needle, true, &q);
+    ptrdiff_t ell = i > j ? i : j;
+    ptrdiff_t per = i > j ? p : q;
+
+    bool periodic = true;
+    for (ptrdiff_t k = 0; k <= ell; k += 1) {
+        if (
+            aven_str_two_way_at(needle, k) !=
+                aven_str_two_way_at(needle, k + per)
+        ) {
+            periodic = false;
+            break;
+        }
+    }
+
+    // For periodic needles memory skips the prefix already known to match
+    // after shifting by the period
+    ptrdiff_t memory = -1;
+    if (!periodic) {
+        per = max(ell + 1, m - ell - 1) + 1;
+    }
+    for (j = 0; j <= hay.len - m;) {
+        i = max(ell, memory) + 1;
+        while (
+            i < m and
+            aven_str_two_way_at(needle, i) == aven_str_two_way_at(hay, i + j)
+        ) {
+            i += 1;
+        }
+        if (i < m) {
+            j += i - ell;
+            memory = -1;
+            continue;
+        }
+
+        i = ell;
+        while (
+            i > memory and
+            aven_str_two_way_at(needle, i) == aven_str_two_way_at(hay, i + j)
+        ) {
+            i -= 1;
+        }
+        if (i <= memory) {
+            return (AvenStrOptionalIndex){ .value = (size_t)j, .valid = true };
+        }
+        j += per;
+        if (periodic) {
+            memory = m - per - 1;
+        }
+    }
+    return (AvenStrOptionalIndex){ 0 };
+}
+
+AVEN_FN AvenStrOptionalIndex aven_str_find(AvenStr str, AvenStr needle) {
+    if (needle.len == 0) {
+        return (AvenStrOptionalIndex){ .value = 0, .valid = true };
+    }
+    if (needle.len > str.len) {
+        return (AvenStrOptionalIndex){ 0 };
+    }
+    if (needle.len == 1) {
+        return aven_str_find_char(str, needle.ptr[0]);
+    }
+
+    size_t last = needle.len - 1;
+    size_t end = str.len - last;
+    size_t work = 0;
+    for (size_t i = 0; i < end;) {
+        // Skip blocks without candidates in a tight loop
+        uint32_t mask = 0;
+        size_t step = AVEN_STR_FIND_BLOCK;
+        while (end - i >= AVEN_STR_FIND_BLOCK) {
+            mask = aven_str_find_block(
+                str.ptr + i,
+                last,
+                needle.ptr[0],
+                needle.ptr[last]
+            );
+            if (mask != 0) {
+                break;
+            }
+            i += AVEN_STR_FIND_BLOCK;
+        }
+        if (mask == 0) {
+            if (i == end) {
+                break;
+            }
+            mask = (
+                str.ptr[i] == needle.ptr[0] and
+                str.ptr[i + last] == needle.ptr[last]
+            ) ? 1 : 0;
+            step = 1;
+        }
+
+        for (; mask != 0; mask &= mask - 1) {
+            size_t index = i + aven_str_ctz(mask);
+            if (
+                aven_str_mem_eq(str.ptr + index + 1, needle.ptr + 1, last - 1)
+            ) {
+                return (AvenStrOptionalIndex){ .value = index, .valid = true };
+            }
+            work += needle.len;
+        }
+        i += step;
+
+        // Verifying candidates is quadratic at worst, e.g. "aab" in "aaaa",
+        // so past a budget proportional to the bytes scanned use Two-Way
+        if (work > 2 * i + 256) {
+            AvenStrTwoWayView hay = {
+                .ptr = (const unsigned char *)str.ptr + i,
+                .len = (ptrdiff_t)(str.len - i),
+            };
+            AvenStrTwoWayView pattern = {
+                .ptr = (const unsigned char *)needle.ptr,
+                .len = (ptrdiff_t)needle.len,
+            };
+            AvenStrOptionalIndex found = aven_str_two_way(hay, pattern);
+            found.value += i;
+            return found;
+        }
+    }
+    return (AvenStrOptionalIndex){ 0 };
+}
+
+AVEN_FN AvenStrOptionalIndex aven_str_find_last(
+    AvenStr str,
+    AvenStr needle
+) {
+    if (needle.len == 0) {
+        return (AvenStrOptionalIndex){ .value = str.len, .valid = true };
+    }
+    if (needle.len > str.len) {
+        return (AvenStrOptionalIndex){ 0 };
+    }
+
+    // Candidate starts below end remain, scanned from the top down
+    size_t last = needle.len - 1;
+    size_t end = str.len - last;
+    size_t work = 0;
+    while (end > 0) {
+        uint32_t mask = 0;
+        size_t start = end;
+        while (start >= AVEN_STR_FIND_BLOCK) {
+            start -= AVEN_STR_FIND_BLOCK;
+            mask = aven_str_find_block(
+                str.ptr + start,
+                last,
+                needle.ptr[0],
+                needle.ptr[last]
+            );
+            if (mask != 0) {
+                break;
+            }
+        }
+        if (mask == 0) {
+            if (start == 0) {
+                break;
+            }
+            start -= 1;
+            mask = (
+                str.ptr[start] == needle.ptr[0] and
+                str.ptr[start + last] == needle.ptr[last]
+            ) ? 1 : 0;
+        }
+
+        while (mask != 0) {
+            uint32_t bit = aven_str_bsr(mask);
+            size_t index = start + bit;
+            if (
+                last == 0 or
+                aven_str_mem_eq(str.ptr + index + 1, needle.ptr + 1, last - 1)
+            ) {
+                return (AvenStrOptionalIndex){ .value = index, .valid = true };
+            }
+            work += needle.len;
+            mask &= ~((uint32_t)1 << bit);
+        }
+        end = start;
+
+        if (work > 2 * (str.len - end) + 256) {
+            AvenStrTwoWayView hay = {
+                .ptr = (const unsigned char *)str.ptr,
+                .len = (ptrdiff_t)(end + last),
+                .reverse = true,
+            };
+            AvenStrTwoWayView pattern = {
+                .ptr = (const unsigned char *)needle.ptr,
+                .len = (ptrdiff_t)needle.len,
+                .reverse = true,
+            };
+            AvenStrOptionalIndex found = aven_str_two_way(hay, pattern);
+            found.value = end + last - found.value - needle.len;
+            return found;
+        }
+    }
+    return (AvenStrOptionalIndex){ 0 };
+}
+
+AVEN_FN AvenStrTokenizer aven_str_tokenizer(AvenStr str, char separator) {
+    return (AvenStrTokenizer){
+        .rest = str,
+        .type = AVEN_STR_TOKENIZER_TYPE_CHAR,
+        .separator = separator,
+    };
+}
+
+AVEN_FN AvenStrTokenizer aven_str_tokenizer_set(
+    AvenStr str,
+    AvenStr separators
+) {
+    AvenStrTokenizer tokenizer = {
+        .rest = str,
+        .type = AVEN_STR_TOKENIZER_TYPE_SET,
+    };
+    for (size_t i = 0; i < separators.len; i += 1) {
+        unsigned char c = (unsigned char)slice_get(separators, i);
+        tokenizer.set[c >> 6] |= (uint64_t)1 << (c & 63);
+    }
+    return tokenizer;
+}
+
+AVEN_FN AvenStrTokenizer aven_str_tokenizer_space(AvenStr str) {
+    return aven_str_tokenizer_set(str, aven_str(" \t\n\v\f\r"));
+}
+
+static inline bool aven_str_tokenizer_is_sep(
+    AvenStrTokenizer *tokenizer,
+    char c
+) {
+    if (tokenizer->type == AVEN_STR_TOKENIZER_TYPE_CHAR) {
+        return c == tokenizer->separator;
+    }
+    unsigned char uc = (unsigned char)c;
+    return ((tokenizer->set[uc >> 6] >> (uc & 63)) & 1) != 0;
+}
+
+AVEN_FN AvenStrOptional aven_str_tokenizer_next(AvenStrTokenizer *tokenizer) {
+    AvenStr rest = tokenizer->rest;
+
+    size_t start = 0;
+    while (
+        start < rest.len and
+        aven_str_tokenizer_is_sep(tokenizer, rest.ptr[start])
+    ) {
+        start += 1;
+    }
+    if (start == rest.len) {
+        tokenizer->rest = (AvenStr){ .ptr = rest.ptr + rest.len };
+        return (AvenStrOptional){ 0 };
+    }
+
+    AvenStr token = { .ptr = rest.ptr + start, .len = rest.len - start };
+    if (tokenizer->type == AVEN_STR_TOKENIZER_TYPE_CHAR) {
+        AvenStrOptionalIndex sep = aven_str_find_char(
+            token,
+            tokenizer->separator
+        );
+        if (sep.valid) {
+            token.len = sep.value;
+        }
+    } else {
+        size_t len = 0;
+        while (
+            len < token.len and
+            !aven_str_tokenizer_is_sep(tokenizer, token.ptr[len])
+        ) {
+            len += 1;
+        }
+        token.len = len;
+    }
+
+    // Skip the separator after the token as well, if there is one
+    size_t end = min(start + token.len + 1, rest.len);
+    tokenizer->rest = (AvenStr){ .ptr = rest.ptr + end, .len = rest.len - end };
+    return (AvenStrOptional){ .value = token, .valid = true };
+}
+
+#define AVEN_STR_UTF8_INVALID 0xffffffffU
+#define AVEN_STR_UTF8_REPLACEMENT 0xfffdU
+
+// Decodes the sequence at the start of ptr and returns its length. For an
+// ill-formed sequence *codepoint is AVEN_STR_UTF8_INVALID and the length is
+// that of its longest valid prefix, at least one byte.
+static size_t aven_str_utf8_decode(
+    const unsigned char *ptr,
+    size_t len,
+    uint32_t *codepoint
+) {
+    unsigned char lead = ptr[0];
+    if (lead < 0x80) {
+        *codepoint = lead;
+        return 1;
+    }
+
+    // The second byte range excludes overlong encodings, surrogates, and
+    // code points past U+10FFFF
+    size_t trail;
+    uint32_t value;
+    unsigned char low = 0x80;
+    unsigned char high = 0xbf;
+    if (lead >= 0xc2 and lead <= 0xdf) {
+        trail = 1;
+        value = lead & 0x1f;
+    } else if (lead >= 0xe0 and lead <= 0xef) {
+        trail = 2;
+        value = lead & 0x0f;
+        if (lead == 0xe0) {
+            low = 0xa0;
+        } else if (lead == 0xed) {
+            high = 0x9f;
+        }
+    } else if (lead >= 0xf0 and lead <= 0xf4) {
+        trail = 3;
+        value = lead & 0x07;
+        if (lead == 0xf0) {
+            low = 0x90;
+        } else if (lead == 0xf4) {
+            high = 0x8f;
+        }
+    } else {
+        *codepoint = AVEN_STR_UTF8_INVALID;
+        return 1;
+    }
+
+    for (size_t i = 1; i <= trail; i += 1) {
+        if (i == len or ptr[i] < low or ptr[i] > high) {
+            *codepoint = AVEN_STR_UTF8_INVALID;
+            return i;
+        }
+        value = (value << 6) | (ptr[i] & 0x3f);
+        low = 0x80;
+        high = 0xbf;
+    }
+
+    *codepoint = value;
+    return trail + 1;
+}
+
+// Validates one sequence at a time, skipping ASCII runs in bulk
+static bool aven_str_utf8_valid_scalar(const unsigned char *ptr, size_t len) {
+    size_t i = 0;
+    while (i < len) {
+#if defined(AVEN_STR_SSE2)
+        while (len - i >= 16) {
+            __m128i chunk = _mm_loadu_si128((const __m128i *)(ptr + i));
+            if (_mm_movemask_epi8(chunk) != 0) {
+                break;
+            }
+            i += 16;
+        }
+#else
+        while (
+            len - i >= 8 and
+            (aven_str_load64((const char *)ptr + i) &
+                (AVEN_STR_SWAR_ONES << 7)) == 0
+        ) {
+            i += 8;
+        }
+#endif
+        if (i == len) {
+            break;
+        }
+
+        uint32_t codepoint;
+        i += aven_str_utf8_decode(ptr + i, len - i, &codepoint);
+        if (codepoint == AVEN_STR_UTF8_INVALID) {
+            return false;
+        }
+    }
+    return true;
+}
+
+#if defined(AVEN_STR_UTF8_AVX2)
+    // Error bits of the Keiser-Lemire lookup tables, a byte pair is invalid
+    // if the tables for the high and low nibble of the first byte and the
+    // high nibble of the second byte share a bit
+    #define AVEN_STR_UTF8_TOO_SHORT (1 << 0)
+    #define AVEN_STR_UTF8_TOO_LONG (1 << 1)
+    #define AVEN_STR_UTF8_OVERLONG_3 (1 << 2)
+    #define AVEN_STR_UTF8_TOO_LARGE (1 << 3)
+    #define AVEN_STR_UTF8_SURROGATE (1 << 4)
+    #define AVEN_STR_UTF8_OVERLONG_2 (1 << 5)
+    #define AVEN_STR_UTF8_TOO_LARGE_1000 (1 << 6)
+    #define AVEN_STR_UTF8_OVERLONG_4 (1 << 6)
+    #define AVEN_STR_UTF8_TWO_CONTS (1 << 7)
+    #define AVEN_STR_UTF8_CARRY (AVEN_STR_UTF8_TOO_SHORT | \
+        AVEN_STR_UTF8_TOO_LONG | AVEN_STR_UTF8_TWO_CONTS)
+
+    AVEN_STR_UTF8_AVX2_FN inline __m256i aven_str_utf8_lookup(
+        __m256i nibbles,
+        const unsigned char *table
+    ) {
+        __m128i half = _mm_loadu_si128((const __m128i *)table);
+        return _mm256_shuffle_epi8(_mm256_broadcastsi128_si256(half), nibbles);
+    }
+
+    // The bytes of input shifted right by n, shifting in the end of prev
+    AVEN_STR_UTF8_AVX2_FN inline __m256i aven_str_utf8_prev(
+        __m256i input,
+        __m256i prev,
+        int n
+    ) {
+        __m256i straddle = _mm256_permute2x128_si256(prev, input, 0x21);
+        switch (n) {
+            case 1: return _mm256_alignr_epi8(input, straddle, 15);
+            case 2: return _mm256_alignr_epi8(input, straddle, 14);
+            default: return _mm256_alignr_epi8(input, straddle, 13);
+        }
+    }
+
+    // Returns non-zero bytes where the 32 bytes of input, following prev,
+    // are not valid UTF-8
+    AVEN_STR_UTF8_AVX2_FN inline __m256i aven_str_utf8_check_block(
+        __m256i input,
+        __m256i prev
+    ) {
+        static const unsigned char byte_1_high[16] = {
+            // 0___ ASCII lead
+            AVEN_STR_UTF8_TOO_LONG, AVEN_STR_UTF8_TOO_LONG,
+            AVEN_STR_UTF8_TOO_LONG, AVEN_STR_UTF8_TOO_LONG,
+            AVEN_STR_UTF8_TOO_LONG, AVEN_STR_UTF8_TOO_LONG,
+            AVEN_STR_UTF8_TOO_LONG, AVEN_STR_UTF8_TOO_LONG,
+            // 10__ continuation
+            AVEN_STR_UTF8_TWO_CONTS, AVEN_STR_UTF8_TWO_CONTS,
+            AVEN_STR_UTF8_TWO_CONTS, AVEN_STR_UTF8_TWO_CONTS,
+            // 1100 two byte lead
+            AVEN_STR_UTF8_TOO_SHORT | AVEN_STR_UTF8_OVERLONG_2,
+            // 1101 two byte lead
+            AVEN_STR_UTF8_TOO_SHORT,
+            // 1110 three byte lead
+            AVEN_STR_UTF8_TOO_SHORT | AVEN_STR_UTF8_OVERLONG_3 |
+                AVEN_STR_UTF8_SURROGATE,
+            // 1111 four byte lead
+            AVEN_STR_UTF8_TOO_SHORT | AVEN_STR_UTF8_TOO_LARGE |
+                AVEN_STR_UTF8_TOO_LARGE_1000 | AVEN_STR_UTF8_OVERLONG_4,
+        };
+        static const unsigned char byte_1_low[16] = {
+            AVEN_STR_UTF8_CARRY | AVEN_STR_UTF8_OVERLONG_3 |
+                AVEN_STR_UTF8_OVERLONG_2 | AVEN_STR_UTF8_OVERLONG_4,
+            AVEN_STR_UTF8_CARRY | AVEN_STR_UTF8_OVERLONG_2,
+            AVEN_STR_UTF8_CARRY,
+            AVEN_STR_UTF8_CARRY,
+            AVEN_STR_UTF8_CARRY | AVEN_STR_UTF8_TOO_LARGE,
+            AVEN_STR_UTF8_CARRY | AVEN_STR_UTF8_TOO_LARGE |
+                AVEN_STR_UTF8_TOO_LARGE_1000,
+            AVEN_STR_UTF8_CARRY | AVEN_STR_UTF8_TOO_LARGE |
+                AVEN_STR_UTF8_TOO_LARGE_1000,
+            AVEN_STR_UTF8_CARRY | AVEN_STR_UTF8_TOO_LARGE |
+                AVEN_STR_UTF8_TOO_LARGE_1000,
+            AVEN_STR_UTF8_CARRY | AVEN_STR_UTF8_TOO_LARGE |
+                AVEN_STR_UTF8_TOO_LARGE_1000,
+            AVEN_STR_UTF8_CARRY | AVEN_STR_UTF8_TOO_LARGE |
+                AVEN_STR_UTF8_TOO_LARGE_1000,
+            AVEN_STR_UTF8_CARRY | AVEN_STR_UTF8_TOO_LARGE |
+                AVEN_STR_UTF8_TOO_LARGE_1000,
+            AVEN_STR_UTF8_CARRY | AVEN_STR_UTF8_TOO_LARGE |
+                AVEN_STR_UTF8_TOO_LARGE_1000,
+            AVEN_STR_UTF8_CARRY | AVEN_STR_UTF8_TOO_LARGE |
+                AVEN_STR_UTF8_TOO_LARGE_1000,
+            AVEN_STR_UTF8_CARRY | AVEN_STR_UTF8_TOO_LARGE |
+                AVEN_STR_UTF8_TOO_LARGE_1000 | AVEN_STR_UTF8_SURROGATE,
+            AVEN_STR_UTF8_CARRY | AVEN_STR_UTF8_TOO_LARGE |
+                AVEN_STR_UTF8_TOO_LARGE_1000,
+            AVEN_STR_UTF8_CARRY | AVEN_STR_UTF8_TOO_LARGE |
+                AVEN_STR_UTF8_TOO_LARGE_1000,
+        };
+        static const unsigned char byte_2_high[16] = {
+            // 0___ ASCII
+            AVEN_STR_UTF8_TOO_SHORT, AVEN_STR_UTF8_TOO_SHORT,
+            AVEN_STR_UTF8_TOO_SHORT, AVEN_STR_UTF8_TOO_SHORT,
+            AVEN_STR_UTF8_TOO_SHORT, AVEN_STR_UTF8_TOO_SHORT,
+            AVEN_STR_UTF8_TOO_SHORT, AVEN_STR_UTF8_TOO_SHORT,
+            // 1000 continuation
+            AVEN_STR_UTF8_TOO_LONG | AVEN_STR_UTF8_OVERLONG_2 |
+                AVEN_STR_UTF8_TWO_CONTS | AVEN_STR_UTF8_OVERLONG_3 |
+                AVEN_STR_UTF8_TOO_LARGE_1000 | AVEN_STR_UTF8_OVERLONG_4,
+            // 1001 continuation
+            AVEN_STR_UTF8_TOO_LONG | AVEN_STR_UTF8_OVERLONG_2 |
+                AVEN_STR_UTF8_TWO_CONTS | AVEN_STR_UTF8_OVERLONG_3 |
+                AVEN_STR_UTF8_TOO_LARGE,
+            // 101_ continuation
+            AVEN_STR_UTF8_TOO_LONG | AVEN_STR_UTF8_OVERLONG_2 |
+                AVEN_STR_UTF8_TWO_CONTS | AVEN_STR_UTF8_SURROGATE |
+                AVEN_STR_UTF8_TOO_LARGE,
+            AVEN_STR_UTF8_TOO_LONG | AVEN_STR_UTF8_OVERLONG_2 |
+                AVEN_STR_UTF8_TWO_CONTS | AVEN_STR_UTF8_SURROGATE |
+                AVEN_STR_UTF8_TOO_LARGE,
+            // 11__ lead
+            AVEN_STR_UTF8_TOO_SHORT, AVEN_STR_UTF8_TOO_SHORT,
+            AVEN_STR_UTF8_TOO_SHORT, AVEN_STR_UTF8_TOO_SHORT,
+        };
+
+        __m256i low_nibble = _mm256_set1_epi8(0x0f);
+        __m256i prev1 = aven_str_utf8_prev(input, prev, 1);
+        __m256i special = _mm256_and_si256(
+            _mm256_and_si256(
+                aven_str_utf8_lookup(
+                    _mm256_and_si256(_mm256_srli_epi16(prev1, 4), low_nibble),
+                    byte_1_high
+                ),
+                aven_str_utf8_lookup(
+                    _mm256_and_si256(prev1, low_nibble),
+                    byte_1_low
+                )
+            ),
+            aven_str_utf8_lookup(
+                _mm256_and_si256(_mm256_srli_epi16(input, 4), low_nibble),
+                byte_2_high
+            )
+        );
+
+        // Bytes two or three after a three or four byte lead must be
+        // continuations, which the pair tables above cannot see
+        __m256i prev2 = aven_str_utf8_prev(input, prev, 2);
+        __m256i prev3 = aven_str_utf8_prev(input, prev, 3);
+        __m256i must_continue = _mm256_or_si256(
+            _mm256_subs_epu8(prev2, _mm256_set1_epi8((char)(0xe0 - 0x80))),
+            _mm256_subs_epu8(prev3, _mm256_set1_epi8((char)(0xf0 - 0x80)))
+        );
+        must_continue = _mm256_and_si256(
+            must_continue,
+            _mm256_set1_epi8((char)0x80)
+        );
+        return _mm256_xor_si256(must_continue, special);
+    }
+
+    AVEN_STR_UTF8_AVX2_FN bool aven_str_utf8_valid_avx2(
+        const unsigned char *ptr,
+        size_t len
+    ) {
+        __m256i prev = _mm256_setzero_si256();
+        __m256i error = _mm256_setzero_si256();
+        // Non-zero where a block ends inside a sequence, which is only an error
+        // if the next block does not start with continuations
+        __m256i incomplete = _mm256_setzero_si256();
+        __m256i incomplete_max = _mm256_setr_epi8(
+            -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+            -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+            (char)(0xf0 - 1), (char)(0xe0 - 1), (char)(0xc0 - 1)
+        );
+
+        size_t i = 0;
+        for (; i + 32 <= len; i += 32) {
+            __m256i input = _mm256_loadu_si256((const __m256i *)(ptr + i));
+            if (_mm256_movemask_epi8(input) == 0) {
+                error = _mm256_or_si256(error, incomplete);
+            } else {
+                error = _mm256_or_si256(
+                    error,
+                    aven_str_utf8_check_block(input, prev)
+                );
+                incomplete = _mm256_subs_epu8(input, incomplete_max);
+            }
+            prev = input;
+            if ((i & 1023) == 0 and !_mm256_testz_si256(error, error)) {
+                return false;
+            }
+        }
+
+        // The tail is padded with zeros, which also catches a sequence cut off
+        // at the end of the string
+        unsigned char tail[32] = { 0 };
+        if (len > i) {
+            memcpy(tail, ptr + i, len - i);
+        }
+        __m256i input = _mm256_loadu_si256((const __m256i *)tail);
+        error = _mm256_or_si256(error, aven_str_utf8_check_block(input, prev));
+        return _mm256_testz_si256(error, error) != 0;
+    }
+#endif
+
+AVEN_FN bool aven_str_utf8_valid(AvenStr str) {
+    const unsigned char *ptr = (const unsigned char *)str.ptr;
+    // Short strings, e.g. most paths, are quicker to check without vectors
+    if (str.len < 32) {
+        return aven_str_utf8_valid_scalar(ptr, str.len);
+    }
+#if defined(__AVX2__)
+    return aven_str_utf8_valid_avx2(ptr, str.len);
+#else
+    #if defined(AVEN_STR_UTF8_AVX2)
+        if (__builtin_cpu_supports("avx2")) {
+            return aven_str_utf8_valid_avx2(ptr, str.len);
+        }
+    #endif
+    return aven_str_utf8_valid_scalar(ptr, str.len);
+#endif
+}
+
+AVEN_FN AvenStrOptionalCodepoint aven_str_utf8_next(
+    AvenStr str,
+    size_t *index
+) {
+    if (*index >= str.len) {
+        return (AvenStrOptionalCodepoint){ 0 };
+    }
+
+    uint32_t codepoint;
+    *index += aven_str_utf8_decode(
+        (const unsigned char *)str.ptr + *index,
+        str.len - *index,
+        &codepoint
+    );
+    if (codepoint == AVEN_STR_UTF8_INVALID) {
+        codepoint = AVEN_STR_UTF8_REPLACEMENT;
+    }
+    return (AvenStrOptionalCodepoint){ .value = codepoint, .valid = true };
+}
+
+typedef struct {
+    uint32_t first;
+    uint32_t last;
+} AvenStrUtf8Range;
+
+static bool aven_str_utf8_in_ranges(
+    uint32_t codepoint,
+    const AvenStrUtf8Range *ranges,
+    size_t len
+) {
+    size_t low = 0;
+    size_t high = len;
+    while (low < high) {
+        size_t mid = low + (high - low) / 2;
+        if (codepoint > ranges[mid].last) {
+            low = mid + 1;
+        } else if (codepoint < ranges[mid].first) {
+            high = mid;
+        } else {
+            return true;
+        }
+    }
+    return false;
+}
+
+AVEN_FN size_t aven_str_utf8_width(uint32_t codepoint) {
+    // Combining marks, zero width spaces and joiners, variation selectors
+    static const AvenStrUtf8Range zero_width[] = {
+        { 0x0300, 0x036f }, { 0x0483, 0x0489 }, { 0x0591, 0x05bd },
+        { 0x0610, 0x061a }, { 0x064b, 0x065f }, { 0x0670, 0x0670 },
+        { 0x06d6, 0x06dc }, { 0x06df, 0x06e4 }, { 0x0900, 0x0902 },
+        { 0x093a, 0x093a }, { 0x093c, 0x093c }, { 0x0941, 0x0948 },
+        { 0x094d, 0x094d }, { 0x0e31, 0x0e31 }, { 0x0e34, 0x0e3a },
+        { 0x0e47, 0x0e4e }, { 0x1ab0, 0x1aff }, { 0x1dc0, 0x1dff },
+        { 0x200b, 0x200f }, { 0x2028, 0x202e }, { 0x2060, 0x2064 },
+        { 0x20d0, 0x20ff }, { 0xfe00, 0xfe0f }, { 0xfe20, 0xfe2f },
+        { 0xfeff, 0xfeff }, { 0xe0100, 0xe01ef },
+    };
+    // East Asian wide and fullwidth characters and emoji
+    static const AvenStrUtf8Range double_width[] = {
+        { 0x1100, 0x115f }, { 0x231a, 0x231b }, { 0x2329, 0x232a },
+        { 0x23e9, 0x23ec }, { 0x23f0, 0x23f0 }, { 0x23f3, 0x23f3 },
+        { 0x25fd, 0x25fe }, { 0x2614, 0x2615 }, { 0x2648, 0x2653 },
+        { 0x26a1, 0x26a1 }, { 0x26aa, 0x26ab }, { 0x26bd, 0x26be },
+        { 0x26c4, 0x26c5 }, { 0x26d4, 0x26d4 }, { 0x26ea, 0x26ea },
+        { 0x26f2, 0x26f5 }, { 0x26fa, 0x26fa }, { 0x26fd, 0x26fd },
+        { 0x2705, 0x2705 }, { 0x270a, 0x270b }, { 0x2728, 0x2728 },
+        { 0x274c, 0x274c }, { 0x2753, 0x2755 }, { 0x2757, 0x2757 },
+        { 0x2795, 0x2797 }, { 0x27b0, 0x27b0 }, { 0x27bf, 0x27bf },
+        { 0x2b1b, 0x2b1c }, { 0x2b50, 0x2b50 }, { 0x2b55, 0x2b55 },
+        { 0x2e80, 0x303e }, { 0x3041, 0x33ff }, { 0x3400, 0x4dbf },
+        { 0x4e00, 0x9fff }, { 0xa000, 0xa4cf }, { 0xa960, 0xa97f },
+        { 0xac00, 0xd7a3 }, { 0xf900, 0xfaff }, { 0xfe10, 0xfe19 },
+        { 0xfe30, 0xfe6f }, { 0xff00, 0xff60 }, { 0xffe0, 0xffe6 },
+        { 0x16fe0, 0x16fe4 }, { 0x17000, 0x18cff }, { 0x1b000, 0x1b2ff },
+        { 0x1f004, 0x1f004 }, { 0x1f0cf, 0x1f0cf }, { 0x1f18e, 0x1f18e },
+        { 0x1f191, 0x1f19a }, { 0x1f200, 0x1f251 }, { 0x1f300, 0x1f320 },
+        { 0x1f32d, 0x1f335 }, { 0x1f337, 0x1f37c }, { 0x1f37e, 0x1f393 },
+        { 0x1f3a0, 0x1f3ca }, { 0x1f3cf, 0x1f3d3 }, { 0x1f3e0, 0x1f3f0 },
+        { 0x1f3f4, 0x1f3f4 }, { 0x1f3f8, 0x1f43e }, { 0x1f440, 0x1f440 },
+        { 0x1f442, 0x1f4fc }, { 0x1f4ff, 0x1f53d }, { 0x1f54b, 0x1f54e },
+        { 0x1f550, 0x1f567 }, { 0x1f57a, 0x1f57a }, { 0x1f595, 0x1f596 },
+        { 0x1f5a4, 0x1f5a4 }, { 0x1f5fb, 0x1f64f }, { 0x1f680, 0x1f6c5 },
+        { 0x1f6cc, 0x1f6cc }, { 0x1f6d0, 0x1f6d2 }, { 0x1f6d5, 0x1f6d7 },
+        { 0x1f6eb, 0x1f6ec }, { 0x1f6f4, 0x1f6fc }, { 0x1f7e0, 0x1f7eb },
+        { 0x1f90c, 0x1f93a }, { 0x1f93c, 0x1f945 }, { 0x1f947, 0x1f9ff },
+        { 0x1fa70, 0x1faff }, { 0x20000, 0x2fffd }, { 0x30000, 0x3fffd },
+    };
+
+    if (codepoint < 0x20 or (codepoint >= 0x7f and codepoint < 0xa0)) {
+        return 0;
+    }
+    if (codepoint < 0x300) {
+        return 1;
+    }
+    if (aven_str_utf8_in_ranges(codepoint, zero_width, countof(zero_width))) {
+        return 0;
+    }
+    if (
+        codepoint >= 0x1100 and
+        aven_str_utf8_in_ranges(
+            codepoint,
+            double_width,
+            countof(double_width)
+        )
+    ) {
+        return 2;
+    }
+    return 1;
+}
+
+AVEN_FN AvenStr aven_str_utf8_truncate(AvenStr str, size_t width) {
+    size_t used = 0;
+    size_t end = 0;
+    size_t index = 0;
+    for (
+        AvenStrOptionalCodepoint codepoint = aven_str_utf8_next(str, &index);
+        codepoint.valid;
+        codepoint = aven_str_utf8_next(str, &index)
+    ) {
+        used += aven_str_utf8_width(codepoint.value);
+        if (used > width) {
+            break;
+        }
+        end = index;
+    }
+    return (AvenStr){ .ptr = str.ptr, .len = end };
+}
+
+#endif // AVEN_IMPLEMENTATION
+
 #endif // AVEN_STR_H
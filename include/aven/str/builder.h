@@ -0,0 +1,804 @@
+#ifndef AVEN_STR_BUILDER_H
+#define AVEN_STR_BUILDER_H
+
+#include "../../aven.h"
+#include "../arena.h"
+#include "../str.h"
+
+#include <stdarg.h>
+
+#ifndef AVEN_STR_FMT_MAX_PRECISION
+    #define AVEN_STR_FMT_MAX_PRECISION 32
+#endif
+
+// A growable string in an arena. Growth goes through aven_arena_realloc, so
+// while the builder holds the most recent allocation it extends in place and
+// nothing is copied. A zeroed builder is empty and valid. The contents are
+// always followed by room for a NUL terminator.
+typedef struct {
+    char *ptr;
+    size_t len;
+    size_t cap;
+} AvenStrBuilder;
+
+AVEN_FN AvenStrBuilder aven_str_builder_init(size_t cap, AvenArena *arena);
+// Makes room for len more bytes and returns where they go, the caller writes
+// them and adds len to builder->len
+AVEN_FN char *aven_str_builder_reserve(
+    AvenStrBuilder *builder,
+    size_t len,
+    AvenArena *arena
+);
+// Returns the NUL terminated contents and gives any unused capacity back to
+// the arena if the builder holds the most recent allocation
+AVEN_FN AvenStr aven_str_builder_finish(
+    AvenStrBuilder *builder,
+    AvenArena *arena
+);
+
+AVEN_FN void aven_str_builder_push(
+    AvenStrBuilder *builder,
+    AvenStr str,
+    AvenArena *arena
+);
+AVEN_FN void aven_str_builder_push_char(
+    AvenStrBuilder *builder,
+    char c,
+    AvenArena *arena
+);
+AVEN_FN void aven_str_builder_push_uint(
+    AvenStrBuilder *builder,
+    uint64_t value,
+    AvenArena *arena
+);
+AVEN_FN void aven_str_builder_push_int(
+    AvenStrBuilder *builder,
+    int64_t value,
+    AvenArena *arena
+);
+// Lower case hex digits without a prefix or leading zeros
+AVEN_FN void aven_str_builder_push_hex(
+    AvenStrBuilder *builder,
+    uint64_t value,
+    AvenArena *arena
+);
+// Fixed notation with precision fractional digits, like "%.*f"
+AVEN_FN void aven_str_builder_push_float(
+    AvenStrBuilder *builder,
+    double value,
+    size_t precision,
+    AvenArena *arena
+);
+
+// A printf subset that formats straight into the builder in one pass, with
+// flags '-', '0', '+', ' ', width and precision (also as '*'), length
+// modifiers hh, h, l, ll, z, j, t, and conversions d i u x X c s p f e %.
+// Use "%.*s" with (int)str.len, str.ptr for an AvenStr. Floats are rounded
+// from a double scaled by a power of ten, so unlike printf they are accurate
+// to about 15 significant digits rather than correctly rounded, and
+// precision is capped at AVEN_STR_FMT_MAX_PRECISION.
+#if __has_attribute(format)
+    __attribute__((format(printf, 3, 4)))
+#endif
+AVEN_FN void aven_str_builder_fmt(
+    AvenStrBuilder *builder,
+    AvenArena *arena,
+    const char *fmt,
+    ...
+);
+AVEN_FN void aven_str_builder_vfmt(
+    AvenStrBuilder *builder,
+    AvenArena *arena,
+    const char *fmt,
+    va_list args
+);
+// Returns a new NUL terminated string formatted like aven_str_builder_fmt
+#if __has_attribute(format)
+    __attribute__((format(printf, 2, 3)))
+#endif
+AVEN_FN AvenStr aven_str_fmt(AvenArena *arena, const char *fmt, ...);
+
+#ifdef AVEN_IMPLEMENTATION
+
+#include <math.h>
+#include <string.h>
+
+// The largest fixed notation double has 309 integer digits
+#define AVEN_STR_FMT_FLOAT_MAX (309 + 1 + AVEN_STR_FMT_MAX_PRECISION)
+// Digits that fit in a uint64_t with room for rounding
+#define AVEN_STR_FMT_FLOAT_DIGITS 17
+
+static const char aven_str_fmt_pairs[] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+static const uint64_t aven_str_fmt_pow10[] = {
+    1ULL,
+    10ULL,
+    100ULL,
+    1000ULL,
+    10000ULL,
+    100000ULL,
+    1000000ULL,
+    10000000ULL,
+    100000000ULL,
+    1000000000ULL,
+    10000000000ULL,
+    100000000000ULL,
+    1000000000000ULL,
+    10000000000000ULL,
+    100000000000000ULL,
+    1000000000000000ULL,
+    10000000000000000ULL,
+    100000000000000000ULL,
+    1000000000000000000ULL,
+};
+
+AVEN_FN AvenStrBuilder aven_str_builder_init(size_t cap, AvenArena *arena) {
+    AvenStrBuilder builder = { .cap = cap };
+    builder.ptr = aven_arena_alloc(arena, cap + 1, 1);
+    return builder;
+}
+
+AVEN_FN char *aven_str_builder_reserve(
+    AvenStrBuilder *builder,
+    size_t len,
+    AvenArena *arena
+) {
+    if (builder->ptr == NULL or builder->cap - builder->len < len) {
+        size_t cap = max(2 * builder->cap, builder->len + len);
+        cap = max(cap, (size_t)15);
+        builder->ptr = aven_arena_realloc(
+            arena,
+            builder->ptr,
+            builder->ptr == NULL ? 0 : builder->cap + 1,
+            cap + 1,
+            1
+        );
+        builder->cap = cap;
+    }
+    return builder->ptr + builder->len;
+}
+
+AVEN_FN AvenStr aven_str_builder_finish(
+    AvenStrBuilder *builder,
+    AvenArena *arena
+) {
+    aven_str_builder_reserve(builder, 0, arena);
+    if (
+        aven_arena_resize(
+            arena,
+            builder->ptr,
+            builder->cap + 1,
+            builder->len + 1
+        )
+    ) {
+        builder->cap = builder->len;
+    }
+
+    builder->ptr[builder->len] = 0;
+    return (AvenStr){ .ptr = builder->ptr, .len = builder->len };
+}
+
+AVEN_FN void aven_str_builder_push(
+    AvenStrBuilder *builder,
+    AvenStr str,
+    AvenArena *arena
+) {
+    char *dst = aven_str_builder_reserve(builder, str.len, arena);
+    if (str.len > 0) {
+        memcpy(dst, str.ptr, str.len);
+    }
+    builder->len += str.len;
+}
+
+AVEN_FN void aven_str_builder_push_char(
+    AvenStrBuilder *builder,
+    char c,
+    AvenArena *arena
+) {
+    char *dst = aven_str_builder_reserve(builder, 1, arena);
+    *dst = c;
+    builder->len += 1;
+}
+
+static inline size_t aven_str_fmt_dec_len(uint64_t value) {
+    size_t len = 1;
+    while (value >= 100) {
+        value /= 100;
+        len += 2;
+    }
+    return len + (value >= 10 ? 1 : 0);
+}
+
+// Writes the digits of value so they end just before end, two at a time
+static void aven_str_fmt_dec_write(char *end, uint64_t value) {
+    while (value >= 100) {
+        size_t pair = (size_t)(value % 100) * 2;
+        value /= 100;
+        end -= 2;
+        end[0] = aven_str_fmt_pairs[pair];
+        end[1] = aven_str_fmt_pairs[pair + 1];
+    }
+    if (value >= 10) {
+        size_t pair = (size_t)value * 2;
+        end[-2] = aven_str_fmt_pairs[pair];
+        end[-1] = aven_str_fmt_pairs[pair + 1];
+    } else {
+        end[-1] = (char)('0' + value);
+    }
+}
+
+static inline size_t aven_str_fmt_hex_len(uint64_t value) {
+    size_t len = 1;
+    while (value >= 16) {
+        value >>= 4;
+        len += 1;
+    }
+    return len;
+}
+
+static void aven_str_fmt_hex_write(char *end, uint64_t value, bool upper) {
+    const char *digits = upper ? "0123456789ABCDEF" : "0123456789abcdef";
+    do {
+        end -= 1;
+        *end = digits[value & 0xf];
+        value >>= 4;
+    } while (value != 0);
+}
+
+// Writes width digits of value, padded with leading zeros
+static char *aven_str_fmt_dec_write_fixed(
+    char *dst,
+    uint64_t value,
+    size_t width
+) {
+    size_t len = aven_str_fmt_dec_len(value);
+    memset(dst, '0', width - len);
+    aven_str_fmt_dec_write(dst + width, value);
+    return dst + width;
+}
+
+// Writes a finite non-negative value in fixed (like "%f") or exponent (like
+// "%e") notation to buffer, which holds AVEN_STR_FMT_FLOAT_MAX bytes, and
+// returns the length
+static size_t aven_str_fmt_float_write(
+    char *buffer,
+    double value,
+    size_t precision,
+    bool exponent
+) {
+    precision = min(precision, (size_t)AVEN_STR_FMT_MAX_PRECISION);
+    size_t digits = min(precision, (size_t)AVEN_STR_FMT_FLOAT_DIGITS);
+    uint64_t scale = aven_str_fmt_pow10[digits];
+    char *dst = buffer;
+
+    int exp = 0;
+    uint64_t whole = 0;
+    uint64_t frac = 0;
+    size_t whole_zeros = 0;
+    if (exponent) {
+        if (value != 0.0) {
+            while (value >= 1e16) {
+                value /= 1e16;
+                exp += 16;
+            }
+            while (value >= 10.0) {
+                value /= 10.0;
+                exp += 1;
+            }
+            while (value < 1e-15) {
+                value *= 1e16;
+                exp -= 16;
+            }
+            while (value < 1.0) {
+                value *= 10.0;
+                exp -= 1;
+            }
+        }
+
+        uint64_t rounded = (uint64_t)(value * (double)scale + 0.5);
+        if (rounded >= 10 * scale) {
+            rounded = scale;
+            exp += 1;
+        }
+        whole = rounded / scale;
+        frac = rounded % scale;
+    } else if (value < 1.8e19) {
+        // Split off the integer part first, as modf would, so the scaled
+        // fraction fits and keeps its digits. Subtracting the truncated value
+        // is exact.
+        whole = (uint64_t)value;
+        frac = (uint64_t)((value - (double)whole) * (double)scale + 0.5);
+        if (frac >= scale) {
+            whole += 1;
+            frac -= scale;
+        }
+    } else {
+        // Doubles this large are integers, digits beyond the precision of a
+        // double are written as zeros
+        while (value >= 1e34) {
+            value /= 1e16;
+            whole_zeros += 16;
+        }
+        while (value >= 1e18) {
+            value /= 10.0;
+            whole_zeros += 1;
+        }
+        whole = (uint64_t)(value + 0.5);
+    }
+
+    size_t whole_len = aven_str_fmt_dec_len(whole);
+    aven_str_fmt_dec_write(dst + whole_len, whole);
+    dst += whole_len;
+    memset(dst, '0', whole_zeros);
+    dst += whole_zeros;
+
+    if (precision > 0) {
+        *dst = '.';
+        dst += 1;
+        dst = aven_str_fmt_dec_write_fixed(dst, frac, digits);
+        memset(dst, '0', precision - digits);
+        dst += precision - digits;
+    }
+
+    if (exponent) {
+        dst[0] = 'e';
+        dst[1] = exp < 0 ? '-' : '+';
+        dst += 2;
+        uint64_t exp_abs = (uint64_t)(exp < 0 ? -exp : exp);
+        dst = aven_str_fmt_dec_write_fixed(
+            dst,
+            exp_abs,
+            max(aven_str_fmt_dec_len(exp_abs), (size_t)2)
+        );
+    }
+
+    return (size_t)(dst - buffer);
+}
+
+AVEN_FN void aven_str_builder_push_uint(
+    AvenStrBuilder *builder,
+    uint64_t value,
+    AvenArena *arena
+) {
+    size_t len = aven_str_fmt_dec_len(value);
+    char *dst = aven_str_builder_reserve(builder, len, arena);
+    aven_str_fmt_dec_write(dst + len, value);
+    builder->len += len;
+}
+
+AVEN_FN void aven_str_builder_push_int(
+    AvenStrBuilder *builder,
+    int64_t value,
+    AvenArena *arena
+) {
+    uint64_t magnitude = (uint64_t)value;
+    if (value < 0) {
+        aven_str_builder_push_char(builder, '-', arena);
+        magnitude = 0 - magnitude;
+    }
+    aven_str_builder_push_uint(builder, magnitude, arena);
+}
+
+AVEN_FN void aven_str_builder_push_hex(
+    AvenStrBuilder *builder,
+    uint64_t value,
+    AvenArena *arena
+) {
+    size_t len = aven_str_fmt_hex_len(value);
+    char *dst = aven_str_builder_reserve(builder, len, arena);
+    aven_str_fmt_hex_write(dst + len, value, false);
+    builder->len += len;
+}
+
+AVEN_FN void aven_str_builder_push_float(
+    AvenStrBuilder *builder,
+    double value,
+    size_t precision,
+    AvenArena *arena
+) {
+    aven_str_builder_fmt(builder, arena, "%.*f", (int)precision, value);
+}
+
+typedef struct {
+    size_t width;
+    size_t precision;
+    bool has_precision;
+    bool left;
+    bool zero;
+    char sign;
+} AvenStrFmtSpec;
+
+// Writes prefix, zero padding, then body, all padded to the spec width
+static void aven_str_fmt_emit(
+    AvenStrBuilder *builder,
+    AvenStrFmtSpec *spec,
+    AvenStr prefix,
+    size_t zeros,
+    AvenStr body,
+    AvenArena *arena
+) {
+    size_t len = prefix.len + zeros + body.len;
+    size_t pad = spec->width > len ? spec->width - len : 0;
+    char *dst = aven_str_builder_reserve(builder, len + pad, arena);
+
+    if (!spec->left) {
+        memset(dst, ' ', pad);
+        dst += pad;
+    }
+    if (prefix.len > 0) {
+        memcpy(dst, prefix.ptr, prefix.len);
+        dst += prefix.len;
+    }
+    memset(dst, '0', zeros);
+    dst += zeros;
+    if (body.len > 0) {
+        memcpy(dst, body.ptr, body.len);
+        dst += body.len;
+    }
+    if (spec->left) {
+        memset(dst, ' ', pad);
+    }
+
+    builder->len += len + pad;
+}
+
+// Zero flag padding goes between the prefix and the digits
+static inline size_t aven_str_fmt_zeros(
+    AvenStrFmtSpec *spec,
+    size_t prefix_len,
+    size_t digits_len
+) {
+    if (spec->left or !spec->zero) {
+        return 0;
+    }
+    size_t len = prefix_len + digits_len;
+    return spec->width > len ? spec->width - len : 0;
+}
+
+static void aven_str_fmt_integer(
+    AvenStrBuilder *builder,
+    AvenStrFmtSpec *spec,
+    uint64_t value,
+    bool negative,
+    char conversion,
+    AvenArena *arena
+) {
+    char prefix_buffer[3];
+    AvenStr prefix = { .ptr = prefix_buffer };
+    if (negative) {
+        prefix_buffer[prefix.len] = '-';
+        prefix.len += 1;
+    } else if (spec->sign != 0) {
+        prefix_buffer[prefix.len] = spec->sign;
+        prefix.len += 1;
+    }
+    if (conversion == 'p') {
+        prefix_buffer[prefix.len] = '0';
+        prefix_buffer[prefix.len + 1] = 'x';
+        prefix.len += 2;
+    }
+
+    bool hex = conversion == 'x' or conversion == 'X' or conversion == 'p';
+    char digits[20];
+    AvenStr body = { .ptr = digits };
+    if (hex) {
+        body.len = aven_str_fmt_hex_len(value);
+        aven_str_fmt_hex_write(digits + body.len, value, conversion == 'X');
+    } else {
+        body.len = aven_str_fmt_dec_len(value);
+        aven_str_fmt_dec_write(digits + body.len, value);
+    }
+
+    // As in printf, precision is a minimum digit count and a precision of
+    // zero prints nothing for zero
+    size_t zeros = 0;
+    if (spec->has_precision) {
+        if (spec->precision == 0 and value == 0) {
+            body.len = 0;
+        }
+        if (spec->precision > body.len) {
+            zeros = spec->precision - body.len;
+        }
+    } else {
+        zeros = aven_str_fmt_zeros(spec, prefix.len, body.len);
+    }
+
+    aven_str_fmt_emit(builder, spec, prefix, zeros, body, arena);
+}
+
+static void aven_str_fmt_float(
+    AvenStrBuilder *builder,
+    AvenStrFmtSpec *spec,
+    double value,
+    char conversion,
+    AvenArena *arena
+) {
+    char sign = spec->sign;
+    if (signbit(value)) {
+        sign = '-';
+        value = -value;
+    }
+    AvenStr prefix = { .ptr = &sign, .len = sign != 0 ? 1 : 0 };
+
+    if (isnan(value)) {
+        spec->zero = false;
+        aven_str_fmt_emit(builder, spec, prefix, 0, aven_str("nan"), arena);
+        return;
+    }
+    if (isinf(value)) {
+        spec->zero = false;
+        aven_str_fmt_emit(builder, spec, prefix, 0, aven_str("inf"), arena);
+        return;
+    }
+
+    char buffer[AVEN_STR_FMT_FLOAT_MAX];
+    AvenStr body = { .ptr = buffer };
+    body.len = aven_str_fmt_float_write(
+        buffer,
+        value,
+        spec->has_precision ? spec->precision : 6,
+        conversion == 'e'
+    );
+
+    size_t zeros = aven_str_fmt_zeros(spec, prefix.len, body.len);
+    aven_str_fmt_emit(builder, spec, prefix, zeros, body, arena);
+}
+
+static size_t aven_str_fmt_parse_num(const char **fmt) {
+    size_t num = 0;
+    while (**fmt >= '0' and **fmt <= '9') {
+        num = num * 10 + (size_t)(**fmt - '0');
+        *fmt += 1;
+    }
+    return num;
+}
+
+AVEN_FN void aven_str_builder_vfmt(
+    AvenStrBuilder *builder,
+    AvenArena *arena,
+    const char *fmt,
+    va_list args
+) {
+    for (;;) {
+        // Copy literal text up to the next conversion in one go
+        const char *start = fmt;
+        while (*fmt != 0 and *fmt != '%') {
+            fmt += 1;
+        }
+        aven_str_builder_push(
+            builder,
+            (AvenStr){ .ptr = (char *)start, .len = (size_t)(fmt - start) },
+            arena
+        );
+        if (*fmt == 0) {
+            break;
+        }
+        fmt += 1;
+
+        AvenStrFmtSpec spec = { 0 };
+        for (;; fmt += 1) {
+            if (*fmt == '-') {
+                spec.left = true;
+            } else if (*fmt == '0') {
+                spec.zero = true;
+            } else if (*fmt == '+') {
+                spec.sign = '+';
+            } else if (*fmt == ' ') {
+                if (spec.sign == 0) {
+                    spec.sign = ' ';
+                }
+            } else {
+                break;
+            }
+        }
+
+        if (*fmt == '*') {
+            int width = va_arg(args, int);
+            if (width < 0) {
+                spec.left = true;
+                width = -width;
+            }
+            spec.width = (size_t)width;
+            fmt += 1;
+        } else {
+            spec.width = aven_str_fmt_parse_num(&fmt);
+        }
+
+        if (*fmt == '.') {
+            fmt += 1;
+            spec.has_precision = true;
+            if (*fmt == '*') {
+                int precision = va_arg(args, int);
+                spec.has_precision = precision >= 0;
+                spec.precision = (size_t)max(precision, 0);
+                fmt += 1;
+            } else {
+                spec.precision = aven_str_fmt_parse_num(&fmt);
+            }
+        }
+
+        // Arguments smaller than int are promoted, so h and hh only
+        // truncate after reading an int
+        char length = 0;
+        if (*fmt == 'h') {
+            length = (fmt[1] == 'h') ? 'H' : 'h';
+            fmt += (fmt[1] == 'h') ? 2 : 1;
+        } else if (*fmt == 'l') {
+            length = (fmt[1] == 'l') ? 'L' : 'l';
+            fmt += (fmt[1] == 'l') ? 2 : 1;
+        } else if (*fmt == 'z' or *fmt == 'j' or *fmt == 't') {
+            length = *fmt;
+            fmt += 1;
+        }
+
+        char conversion = *fmt;
+        if (conversion == 0) {
+            break;
+        }
+        fmt += 1;
+
+        switch (conversion) {
+            case 'd':
+            case 'i': {
+                int64_t value;
+                switch (length) {
+                    case 'l': value = va_arg(args, long); break;
+                    case 'L': value = va_arg(args, long long); break;
+                    case 'z':
+                    case 't': value = va_arg(args, ptrdiff_t); break;
+                    case 'j': value = va_arg(args, intmax_t); break;
+                    case 'h': value = (short)va_arg(args, int); break;
+                    case 'H': value = (signed char)va_arg(args, int); break;
+                    default: value = va_arg(args, int); break;
+                }
+                uint64_t magnitude = (uint64_t)value;
+                if (value < 0) {
+                    magnitude = 0 - magnitude;
+                }
+                aven_str_fmt_integer(
+                    builder,
+                    &spec,
+                    magnitude,
+                    value < 0,
+                    conversion,
+                    arena
+                );
+                break;
+            }
+            case 'u':
+            case 'x':
+            case 'X': {
+                uint64_t value;
+                switch (length) {
+                    case 'l': value = va_arg(args, unsigned long); break;
+                    case 'L': value = va_arg(args, unsigned long long); break;
+                    case 'z': value = va_arg(args, size_t); break;
+                    case 't': value = (uint64_t)va_arg(args, ptrdiff_t); break;
+                    case 'j': value = va_arg(args, uintmax_t); break;
+                    case 'h':
+                        value = (unsigned short)va_arg(args, unsigned int);
+                        break;
+                    case 'H':
+                        value = (unsigned char)va_arg(args, unsigned int);
+                        break;
+                    default: value = va_arg(args, unsigned int); break;
+                }
+                spec.sign = 0;
+                aven_str_fmt_integer(
+                    builder,
+                    &spec,
+                    value,
+                    false,
+                    conversion,
+                    arena
+                );
+                break;
+            }
+            case 'p': {
+                uintptr_t value = (uintptr_t)va_arg(args, void *);
+                spec.sign = 0;
+                aven_str_fmt_integer(
+                    builder,
+                    &spec,
+                    value,
+                    false,
+                    conversion,
+                    arena
+                );
+                break;
+            }
+            case 'f':
+            case 'e': {
+                double value = va_arg(args, double);
+                aven_str_fmt_float(builder, &spec, value, conversion, arena);
+                break;
+            }
+            case 'c': {
+                char c = (char)va_arg(args, int);
+                spec.zero = false;
+                aven_str_fmt_emit(
+                    builder,
+                    &spec,
+                    (AvenStr){ 0 },
+                    0,
+                    (AvenStr){ .ptr = &c, .len = 1 },
+                    arena
+                );
+                break;
+            }
+            case 's': {
+                char *cstr = va_arg(args, char *);
+                if (cstr == NULL) {
+                    cstr = "(null)";
+                }
+                // With a precision the string need not be NUL terminated
+                AvenStr str = { .ptr = cstr };
+                if (spec.has_precision) {
+                    char *end = memchr(cstr, 0, spec.precision);
+                    str.len = end != NULL ?
+                        (size_t)(end - cstr) :
+                        spec.precision;
+                } else {
+                    str.len = aven_str_cstr_len(cstr);
+                }
+                spec.zero = false;
+                aven_str_fmt_emit(
+                    builder,
+                    &spec,
+                    (AvenStr){ 0 },
+                    0,
+                    str,
+                    arena
+                );
+                break;
+            }
+            case '%': {
+                aven_str_builder_push_char(builder, '%', arena);
+                break;
+            }
+            default: {
+                // Unsupported conversions are copied through verbatim
+                assert(false);
+                aven_str_builder_push_char(builder, conversion, arena);
+                break;
+            }
+        }
+    }
+}
+
+AVEN_FN void aven_str_builder_fmt(
+    AvenStrBuilder *builder,
+    AvenArena *arena,
+    const char *fmt,
+    ...
+) {
+    va_list args;
+    va_start(args, fmt);
+    aven_str_builder_vfmt(builder, arena, fmt, args);
+    va_end(args);
+}
+
+AVEN_FN AvenStr aven_str_fmt(AvenArena *arena, const char *fmt, ...) {
+    AvenStrBuilder builder = { 0 };
+
+    va_list args;
+    va_start(args, fmt);
+    aven_str_builder_vfmt(&builder, arena, fmt, args);
+    va_end(args);
+
+    return aven_str_builder_finish(&builder, arena);
+}
+
+#endif // AVEN_IMPLEMENTATION
+
+#endif // AVEN_STR_BUILDER_H
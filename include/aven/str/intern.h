@@ -0,0 +1,191 @@
+#ifndef AVEN_STR_INTERN_H
+#define AVEN_STR_INTERN_H
+
+#include "../../aven.h"
+#include "../arena.h"
+#include "../hash.h"
+#include "../str.h"
+
+// A canonical string and its hash, two interned strings from the same table
+// are equal exactly when their pointers are
+typedef struct {
+    AvenStr str;
+    uint64_t hash;
+} AvenStrIntern;
+
+typedef Optional(AvenStrIntern) AvenStrInternOptional;
+
+// An arena backed open addressing table of interned strings. Growing the
+// table leaves the old entry array in the arena, which at most doubles the
+// memory used by the entries.
+typedef struct {
+    AvenStrIntern *entries;
+    size_t cap;
+    size_t len;
+} AvenStrInternTable;
+
+static inline bool aven_str_intern_eq(AvenStrIntern s1, AvenStrIntern s2) {
+    return s1.str.ptr == s2.str.ptr;
+}
+
+AVEN_FN AvenStrInternTable aven_str_intern_table_init(
+    size_t cap,
+    AvenArena *arena
+);
+AVEN_FN AvenStrInternOptional aven_str_intern_find(
+    AvenStrInternTable *table,
+    AvenStr str
+);
+// Returns the canonical copy of str, adding a NUL terminated copy to the
+// arena the first time a string is seen
+AVEN_FN AvenStrIntern aven_str_intern(
+    AvenStrInternTable *table,
+    AvenStr str,
+    AvenArena *arena
+);
+// Like aven_str_intern, but a new string is stored without copying it, so it
+// must outlive the table. If str.ptr is not returned then str was a
+// duplicate, and e.g. its memory can be given back to the arena.
+AVEN_FN AvenStrIntern aven_str_intern_owned(
+    AvenStrInternTable *table,
+    AvenStr str,
+    AvenArena *arena
+);
+
+#ifdef AVEN_IMPLEMENTATION
+
+#include <string.h>
+
+#define AVEN_STR_INTERN_MIN_CAP 16
+
+static inline uint64_t aven_str_intern_hash(AvenStr str) {
+    ByteSlice bytes = { .ptr = (unsigned char *)str.ptr, .len = str.len };
+    return aven_hash(bytes, 0).lo;
+}
+
+AVEN_FN AvenStrInternTable aven_str_intern_table_init(
+    size_t cap,
+    AvenArena *arena
+) {
+    size_t pow2_cap = AVEN_STR_INTERN_MIN_CAP;
+    while (pow2_cap < cap) {
+        pow2_cap *= 2;
+    }
+
+    AvenStrInternTable table = { .cap = pow2_cap };
+    table.entries = aven_arena_create_array(AvenStrIntern, arena, table.cap);
+    memset(table.entries, 0, table.cap * sizeof(*table.entries));
+    return table;
+}
+
+// Returns the index of the entry matching str, or of the empty slot where
+// it belongs; empty slots have a NULL pointer
+static size_t aven_str_intern_slot(
+    AvenStrInternTable *table,
+    AvenStr str,
+    uint64_t hash
+) {
+    size_t mask = table->cap - 1;
+    size_t index = (size_t)hash & mask;
+    for (;;) {
+        AvenStrIntern *entry = &table->entries[index];
+        if (entry->str.ptr == NULL) {
+            return index;
+        }
+        if (
+            entry->hash == hash and
+            aven_str_compare(entry->str, str)
+        ) {
+            return index;
+        }
+        index = (index + 1) & mask;
+    }
+}
+
+static void aven_str_intern_grow(
+    AvenStrInternTable *table,
+    AvenArena *arena
+) {
+    AvenStrInternTable new_table = aven_str_intern_table_init(
+        2 * table->cap,
+        arena
+    );
+    for (size_t i = 0; i < table->cap; i += 1) {
+        AvenStrIntern entry = table->entries[i];
+        if (entry.str.ptr == NULL) {
+            continue;
+        }
+        size_t mask = new_table.cap - 1;
+        size_t index = (size_t)entry.hash & mask;
+        while (new_table.entries[index].str.ptr != NULL) {
+            index = (index + 1) & mask;
+        }
+        new_table.entries[index] = entry;
+    }
+
+    new_table.len = table->len;
+    *table = new_table;
+}
+
+AVEN_FN AvenStrInternOptional aven_str_intern_find(
+    AvenStrInternTable *table,
+    AvenStr str
+) {
+    uint64_t hash = aven_str_intern_hash(str);
+    AvenStrIntern entry = table->entries[
+        aven_str_intern_slot(table, str, hash)
+    ];
+    if (entry.str.ptr == NULL) {
+        return (AvenStrInternOptional){ 0 };
+    }
+    return (AvenStrInternOptional){ .value = entry, .valid = true };
+}
+
+static AvenStrIntern aven_str_intern_insert(
+    AvenStrInternTable *table,
+    AvenStr str,
+    bool copy,
+    AvenArena *arena
+) {
+    uint64_t hash = aven_str_intern_hash(str);
+    size_t index = aven_str_intern_slot(table, str, hash);
+    if (table->entries[index].str.ptr != NULL) {
+        return table->entries[index];
+    }
+
+    // Keep the load factor at most 3/4 so probe sequences stay short
+    if ((table->len + 1) * 4 > table->cap * 3) {
+        aven_str_intern_grow(table, arena);
+        index = aven_str_intern_slot(table, str, hash);
+    }
+
+    if (copy) {
+        str = aven_str_copy(str, arena);
+    }
+    assert(str.ptr != NULL);
+
+    AvenStrIntern entry = { .str = str, .hash = hash };
+    table->entries[index] = entry;
+    table->len += 1;
+    return entry;
+}
+
+AVEN_FN AvenStrIntern aven_str_intern(
+    AvenStrInternTable *table,
+    AvenStr str,
+    AvenArena *arena
+) {
+    return aven_str_intern_insert(table, str, true, arena);
+}
+
+AVEN_FN AvenStrIntern aven_str_intern_owned(
+    AvenStrInternTable *table,
+    AvenStr str,
+    AvenArena *arena
+) {
+    return aven_str_intern_insert(table, str, false, arena);
+}
+
+#endif // AVEN_IMPLEMENTATION
+
+#endif // AVEN_STR_INTERN_H
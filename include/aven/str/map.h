@@ -0,0 +1,321 @@
+#ifndef AVEN_STR_MAP_H
+#define AVEN_STR_MAP_H
+
+#include "../../aven.h"
+#include "../arena.h"
+#include "../hash.h"
+#include "../str.h"
+
+// An arena backed open addressing hash map from AvenStr keys to fixed size
+// values, laid out like a Swiss table: a control byte per slot holds 7 bits
+// of the key hash, and lookups compare a group of 16 control bytes at once
+// (with SSE2 where available) before touching any keys. Keys are stored as
+// views, so they must outlive the map (e.g. interned or arena copied). Growth
+// leaves the old arrays in the arena, which at most doubles their memory.
+typedef struct {
+    unsigned char *ctrl;
+    AvenStr *keys;
+    unsigned char *values;
+    size_t cap;
+    size_t len;
+    size_t deleted;
+    size_t value_size;
+    size_t value_align;
+} AvenStrMap;
+
+typedef struct {
+    AvenStr key;
+    void *value;
+} AvenStrMapEntry;
+
+typedef Optional(AvenStrMapEntry) AvenStrMapOptionalEntry;
+
+AVEN_FN AvenStrMap aven_str_map_init(
+    size_t value_size,
+    size_t value_align,
+    size_t cap,
+    AvenArena *arena
+);
+
+#define aven_str_map_init_type(t, cap, arena) aven_str_map_init( \
+        sizeof(t), \
+        aven_arena_alignof(t), \
+        cap, \
+        arena \
+    )
+
+// Returns a pointer to the value for key, or NULL if it is not in the map
+AVEN_FN void *aven_str_map_get(AvenStrMap *map, AvenStr key);
+// Returns a pointer to the value for key, adding a zeroed value if the key is
+// not in the map yet. Pointers are invalidated when the map grows.
+AVEN_FN void *aven_str_map_insert(
+    AvenStrMap *map,
+    AvenStr key,
+    AvenArena *arena
+);
+AVEN_FN bool aven_str_map_remove(AvenStrMap *map, AvenStr key);
+AVEN_FN void aven_str_map_clear(AvenStrMap *map);
+// Iterates over the entries in no particular order, start with *index = 0
+AVEN_FN AvenStrMapOptionalEntry aven_str_map_next(
+    AvenStrMap *map,
+    size_t *index
+);
+
+#ifdef AVEN_IMPLEMENTATION
+
+#include <string.h>
+
+#if defined(__SSE2__) or defined(_M_X64) or \
+    (defined(_M_IX86_FP) and _M_IX86_FP >= 2)
+    #define AVEN_STR_MAP_SSE2
+    #include <emmintrin.h>
+#endif
+
+#define AVEN_STR_MAP_GROUP_LEN 16
+#define AVEN_STR_MAP_CTRL_EMPTY 0x80
+#define AVEN_STR_MAP_CTRL_DELETED 0xfe
+
+static inline uint64_t aven_str_map_hash(AvenStr key) {
+    ByteSlice bytes = { .ptr = (unsigned char *)key.ptr, .len = key.len };
+    return aven_hash(bytes, 0).lo;
+}
+
+// Full slots hold the top 7 bits of the hash, so their high bit is clear
+static inline unsigned char aven_str_map_h2(uint64_t hash) {
+    return (unsigned char)(hash >> 57);
+}
+
+// Bit i is set if control byte i of the group equals byte
+static inline uint32_t aven_str_map_group_match(
+    const unsigned char *group,
+    unsigned char byte
+) {
+#ifdef AVEN_STR_MAP_SSE2
+    __m128i ctrl = _mm_load_si128((const __m128i *)group);
+    __m128i pattern = _mm_set1_epi8((char)byte);
+    return (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(ctrl, pattern));
+#else
+    uint32_t mask = 0;
+    for (uint32_t i = 0; i < AVEN_STR_MAP_GROUP_LEN; i += 1) {
+        if (group[i] == byte) {
+            mask |= (uint32_t)1 << i;
+        }
+    }
+    return mask;
+#endif
+}
+
+// Bit i is set if slot i of the group is empty or deleted
+static inline uint32_t aven_str_map_group_free(const unsigned char *group) {
+#ifdef AVEN_STR_MAP_SSE2
+    __m128i ctrl = _mm_load_si128((const __m128i *)group);
+    return (uint32_t)_mm_movemask_epi8(ctrl);
+#else
+    uint32_t mask = 0;
+    for (uint32_t i = 0; i < AVEN_STR_MAP_GROUP_LEN; i += 1) {
+        if ((group[i] & 0x80) != 0) {
+            mask |= (uint32_t)1 << i;
+        }
+    }
+    return mask;
+#endif
+}
+
+static inline void *aven_str_map_value(AvenStrMap *map, size_t index) {
+    return map->values + index * map->value_size;
+}
+
+AVEN_FN AvenStrMap aven_str_map_init(
+    size_t value_size,
+    size_t value_align,
+    size_t cap,
+    AvenArena *arena
+) {
+    // Size for cap entries at the maximum load factor of 7/8
+    size_t min_cap = cap + cap / 7;
+    size_t pow2_cap = AVEN_STR_MAP_GROUP_LEN;
+    while (pow2_cap < min_cap) {
+        pow2_cap *= 2;
+    }
+
+    value_size = (value_size + value_align - 1) & ~(value_align - 1);
+    AvenStrMap map = {
+        .cap = pow2_cap,
+        .value_size = value_size,
+        .value_align = value_align,
+    };
+    map.ctrl = aven_arena_alloc(arena, map.cap, AVEN_STR_MAP_GROUP_LEN);
+    memset(map.ctrl, AVEN_STR_MAP_CTRL_EMPTY, map.cap);
+    map.keys = aven_arena_create_array(AvenStr, arena, map.cap);
+    map.values = aven_arena_alloc(arena, map.cap * value_size, value_align);
+
+    return map;
+}
+
+// Probes groups in triangular order, which visits every group since the
+// number of groups is a power of two
+static size_t aven_str_map_find(AvenStrMap *map, AvenStr key, uint64_t hash) {
+    size_t group_mask = map->cap / AVEN_STR_MAP_GROUP_LEN - 1;
+    size_t group = (size_t)hash & group_mask;
+    unsigned char h2 = aven_str_map_h2(hash);
+
+    for (size_t stride = 1;; stride += 1) {
+        size_t start = group * AVEN_STR_MAP_GROUP_LEN;
+        const unsigned char *ctrl = map->ctrl + start;
+
+        uint32_t matches = aven_str_map_group_match(ctrl, h2);
+        while (matches != 0) {
+            size_t index = start + aven_str_ctz(matches);
+            if (aven_str_compare(map->keys[index], key)) {
+                return index;
+            }
+            matches &= matches - 1;
+        }
+
+        // A probe sequence ends at the first group with an empty slot
+        if (aven_str_map_group_match(ctrl, AVEN_STR_MAP_CTRL_EMPTY) != 0) {
+            return map->cap;
+        }
+
+        group = (group + stride) & group_mask;
+    }
+}
+
+static size_t aven_str_map_find_free(AvenStrMap *map, uint64_t hash) {
+    size_t group_mask = map->cap / AVEN_STR_MAP_GROUP_LEN - 1;
+    size_t group = (size_t)hash & group_mask;
+
+    for (size_t stride = 1;; stride += 1) {
+        size_t start = group * AVEN_STR_MAP_GROUP_LEN;
+        uint32_t free_slots = aven_str_map_group_free(map->ctrl + start);
+        if (free_slots != 0) {
+            return start + aven_str_ctz(free_slots);
+        }
+        group = (group + stride) & group_mask;
+    }
+}
+
+static void aven_str_map_rehash(
+    AvenStrMap *map,
+    size_t cap,
+    AvenArena *arena
+) {
+    AvenStrMap new_map = aven_str_map_init(
+        map->value_size,
+        map->value_align,
+        cap,
+        arena
+    );
+
+    for (size_t i = 0; i < map->cap; i += 1) {
+        if ((map->ctrl[i] & 0x80) != 0) {
+            continue;
+        }
+
+        AvenStr key = map->keys[i];
+        uint64_t hash = aven_str_map_hash(key);
+        size_t index = aven_str_map_find_free(&new_map, hash);
+        new_map.ctrl[index] = aven_str_map_h2(hash);
+        new_map.keys[index] = key;
+        memcpy(
+            aven_str_map_value(&new_map, index),
+            aven_str_map_value(map, i),
+            map->value_size
+        );
+    }
+
+    new_map.len = map->len;
+    *map = new_map;
+}
+
+AVEN_FN void *aven_str_map_get(AvenStrMap *map, AvenStr key) {
+    size_t index = aven_str_map_find(map, key, aven_str_map_hash(key));
+    if (index == map->cap) {
+        return NULL;
+    }
+    return aven_str_map_value(map, index);
+}
+
+AVEN_FN void *aven_str_map_insert(
+    AvenStrMap *map,
+    AvenStr key,
+    AvenArena *arena
+) {
+    uint64_t hash = aven_str_map_hash(key);
+    size_t index = aven_str_map_find(map, key, hash);
+    if (index != map->cap) {
+        return aven_str_map_value(map, index);
+    }
+
+    // Keep full and deleted slots at most 7/8 of the table, rehashing at the
+    // same size if that is enough to clear out deleted slots
+    if (8 * (map->len + map->deleted + 1) > 7 * map->cap) {
+        size_t cap = map->len + 1;
+        if (2 * (map->len + 1) > map->cap) {
+            cap = 2 * map->cap;
+        }
+        aven_str_map_rehash(map, cap, arena);
+    }
+
+    index = aven_str_map_find_free(map, hash);
+    if (map->ctrl[index] == AVEN_STR_MAP_CTRL_DELETED) {
+        map->deleted -= 1;
+    }
+    map->ctrl[index] = aven_str_map_h2(hash);
+    map->keys[index] = key;
+    map->len += 1;
+
+    void *value = aven_str_map_value(map, index);
+    memset(value, 0, map->value_size);
+    return value;
+}
+
+AVEN_FN bool aven_str_map_remove(AvenStrMap *map, AvenStr key) {
+    size_t index = aven_str_map_find(map, key, aven_str_map_hash(key));
+    if (index == map->cap) {
+        return false;
+    }
+
+    // Probes stop at groups with an empty slot, so a slot in such a group
+    // can be emptied, otherwise it must stay marked to keep probing past it
+    size_t start = index & ~(size_t)(AVEN_STR_MAP_GROUP_LEN - 1);
+    const unsigned char *group = map->ctrl + start;
+    if (aven_str_map_group_match(group, AVEN_STR_MAP_CTRL_EMPTY) != 0) {
+        map->ctrl[index] = AVEN_STR_MAP_CTRL_EMPTY;
+    } else {
+        map->ctrl[index] = AVEN_STR_MAP_CTRL_DELETED;
+        map->deleted += 1;
+    }
+    map->len -= 1;
+    return true;
+}
+
+AVEN_FN void aven_str_map_clear(AvenStrMap *map) {
+    memset(map->ctrl, AVEN_STR_MAP_CTRL_EMPTY, map->cap);
+    map->len = 0;
+    map->deleted = 0;
+}
+
+AVEN_FN AvenStrMapOptionalEntry aven_str_map_next(
+    AvenStrMap *map,
+    size_t *index
+) {
+    for (; *index < map->cap; *index += 1) {
+        size_t i = *index;
+        if ((map->ctrl[i] & 0x80) == 0) {
+            *index += 1;
+            return (AvenStrMapOptionalEntry){
+                .value = {
+                    .key = map->keys[i],
+                    .value = aven_str_map_value(map, i),
+                },
+                .valid = true,
+            };
+        }
+    }
+    return (AvenStrMapOptionalEntry){ 0 };
+}
+
+#endif // AVEN_IMPLEMENTATION
+
+#endif // AVEN_STR_MAP_H
@@ -0,0 +1,244 @@
+#ifndef AVEN_STR_ROPE_H
+#define AVEN_STR_ROPE_H
+
+#include "../../aven.h"
+#include "../arena.h"
+#include "../str.h"
+
+// Number of pieces per chunk
+#ifndef AVEN_STR_ROPE_CHUNK_LEN
+    #define AVEN_STR_ROPE_CHUNK_LEN 64
+#endif
+
+typedef struct AvenStrRopeChunk AvenStrRopeChunk;
+struct AvenStrRopeChunk {
+    AvenStrRopeChunk *next;
+    size_t len;
+    AvenStr pieces[AVEN_STR_ROPE_CHUNK_LEN];
+};
+
+// A string kept as a list of pieces in arena allocated chunks. Appending a
+// piece stores a view in O(1) without copying, so the pieces must outlive
+// the rope, and the whole string can be written out with scatter writes
+// without ever being materialized. A zeroed rope is empty and valid.
+typedef struct {
+    AvenStrRopeChunk *first;
+    AvenStrRopeChunk *last;
+    size_t len;
+} AvenStrRope;
+
+typedef enum {
+    AVEN_STR_ROPE_WRITE_ERROR_NONE = 0,
+    AVEN_STR_ROPE_WRITE_ERROR_WRITE,
+} AvenStrRopeWriteError;
+
+AVEN_FN void aven_str_rope_push(
+    AvenStrRope *rope,
+    AvenStr str,
+    AvenArena *arena
+);
+// Pushes the strings with separator between them, e.g. a command line
+AVEN_FN void aven_str_rope_push_join(
+    AvenStrRope *rope,
+    AvenStrSlice strs,
+    AvenStr separator,
+    AvenArena *arena
+);
+// Copies the pieces into one NUL terminated string
+AVEN_FN AvenStr aven_str_rope_flatten(AvenStrRope *rope, AvenArena *arena);
+// Writes the pieces to a file descriptor in order, with writev on POSIX
+// systems, retrying partial writes. On Windows the pieces are gathered into
+// a buffer to keep the number of writes down.
+AVEN_FN int aven_str_rope_write(AvenStrRope *rope, int fd);
+
+#ifdef AVEN_IMPLEMENTATION
+
+#include <string.h>
+
+#ifdef _WIN32
+    #include <io.h>
+#else
+    #include <errno.h>
+    #include <limits.h>
+
+    #include <sys/uio.h>
+#endif
+
+// Pieces per writev call, POSIX only guarantees an IOV_MAX of 16
+#ifndef _WIN32
+    #if defined(IOV_MAX) and IOV_MAX < 256
+        #define AVEN_STR_ROPE_IOV_LEN IOV_MAX
+    #elif defined(IOV_MAX) or defined(__linux__)
+        #define AVEN_STR_ROPE_IOV_LEN 256
+    #else
+        #define AVEN_STR_ROPE_IOV_LEN 16
+    #endif
+#endif
+
+AVEN_FN void aven_str_rope_push(
+    AvenStrRope *rope,
+    AvenStr str,
+    AvenArena *arena
+) {
+    if (str.len == 0) {
+        return;
+    }
+
+    if (rope->last == NULL or rope->last->len == AVEN_STR_ROPE_CHUNK_LEN) {
+        AvenStrRopeChunk *chunk = aven_arena_create(AvenStrRopeChunk, arena);
+        chunk->next = NULL;
+        chunk->len = 0;
+        if (rope->last == NULL) {
+            rope->first = chunk;
+        } else {
+            rope->last->next = chunk;
+        }
+        rope->last = chunk;
+    }
+
+    rope->last->pieces[rope->last->len] = str;
+    rope->last->len += 1;
+    rope->len += str.len;
+}
+
+AVEN_FN void aven_str_rope_push_join(
+    AvenStrRope *rope,
+    AvenStrSlice strs,
+    AvenStr separator,
+    AvenArena *arena
+) {
+    for (size_t i = 0; i < strs.len; i += 1) {
+        if (i > 0) {
+            aven_str_rope_push(rope, separator, arena);
+        }
+        aven_str_rope_push(rope, slice_get(strs, i), arena);
+    }
+}
+
+AVEN_FN AvenStr aven_str_rope_flatten(AvenStrRope *rope, AvenArena *arena) {
+    AvenStr str = { .len = rope->len };
+    str.ptr = aven_arena_alloc(arena, str.len + 1, 1);
+
+    char *dst = str.ptr;
+    for (
+        AvenStrRopeChunk *chunk = rope->first;
+        chunk != NULL;
+        chunk = chunk->next
+    ) {
+        for (size_t i = 0; i < chunk->len; i += 1) {
+            memcpy(dst, chunk->pieces[i].ptr, chunk->pieces[i].len);
+            dst += chunk->pieces[i].len;
+        }
+    }
+    str.ptr[str.len] = 0;
+
+    return str;
+}
+
+#ifdef _WIN32
+    static int aven_str_rope_write_all(int fd, const char *ptr, size_t len) {
+        while (len > 0) {
+            size_t count = min(len, (size_t)0x7fffffff);
+            int olen = _write(fd, ptr, (unsigned int)count);
+            if (olen < 0) {
+                return AVEN_STR_ROPE_WRITE_ERROR_WRITE;
+            }
+            ptr += olen;
+            len -= (size_t)olen;
+        }
+        return 0;
+    }
+
+    AVEN_FN int aven_str_rope_write(AvenStrRope *rope, int fd) {
+        char buffer[4096];
+        size_t used = 0;
+        for (
+            AvenStrRopeChunk *chunk = rope->first;
+            chunk != NULL;
+            chunk = chunk->next
+        ) {
+            for (size_t i = 0; i < chunk->len; i += 1) {
+                AvenStr piece = chunk->pieces[i];
+                if (used + piece.len > sizeof(buffer)) {
+                    int error = aven_str_rope_write_all(fd, buffer, used);
+                    if (error != 0) {
+                        return error;
+                    }
+                    used = 0;
+                }
+
+                // Pieces too large to buffer are written directly
+                if (piece.len > sizeof(buffer)) {
+                    int error = aven_str_rope_write_all(
+                        fd,
+                        piece.ptr,
+                        piece.len
+                    );
+                    if (error != 0) {
+                        return error;
+                    }
+                    continue;
+                }
+
+                memcpy(buffer + used, piece.ptr, piece.len);
+                used += piece.len;
+            }
+        }
+        return aven_str_rope_write_all(fd, buffer, used);
+    }
+#else
+    AVEN_FN int aven_str_rope_write(AvenStrRope *rope, int fd) {
+        struct iovec iov[AVEN_STR_ROPE_IOV_LEN];
+        AvenStrRopeChunk *chunk = rope->first;
+        size_t index = 0;
+
+        for (;;) {
+            int iov_len = 0;
+            for (; chunk != NULL; chunk = chunk->next, index = 0) {
+                for (
+                    ;
+                    index < chunk->len and iov_len < AVEN_STR_ROPE_IOV_LEN;
+                    index += 1
+                ) {
+                    iov[iov_len].iov_base = chunk->pieces[index].ptr;
+                    iov[iov_len].iov_len = chunk->pieces[index].len;
+                    iov_len += 1;
+                }
+                if (iov_len == AVEN_STR_ROPE_IOV_LEN) {
+                    break;
+                }
+            }
+            if (iov_len == 0) {
+                return 0;
+            }
+
+            // Retry until this batch is fully written, skipping the
+            // pieces a partial write has already covered
+            struct iovec *pending = iov;
+            while (iov_len > 0) {
+                ssize_t olen = writev(fd, pending, iov_len);
+                if (olen < 0) {
+                    if (errno == EINTR) {
+                        continue;
+                    }
+                    return AVEN_STR_ROPE_WRITE_ERROR_WRITE;
+                }
+
+                size_t written = (size_t)olen;
+                while (iov_len > 0 and written >= pending->iov_len) {
+                    written -= pending->iov_len;
+                    pending += 1;
+                    iov_len -= 1;
+                }
+                if (iov_len > 0) {
+                    pending->iov_base = (char *)pending->iov_base + written;
+                    pending->iov_len -= written;
+                }
+            }
+        }
+    }
+#endif
+
+#endif // AVEN_IMPLEMENTATION
+
+#endif // AVEN_STR_ROPE_H
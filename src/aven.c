@@ -1,14 +1,25 @@
 #if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
-    #define _POSIX_C_SOURCE 200112L
+    #define _POSIX_C_SOURCE 200809L
+#endif
+#if !defined(_WIN32) && !defined(_GNU_SOURCE)
+    #define _GNU_SOURCE
 #endif
 #define AVEN_IMPLEMENTATION
 #define AVEN_IMPLEMENTATION_STU
 #include <aven/arena.h>
+#include <aven/arena/allocator.h>
+#include <aven/arena/pool.h>
 #include <aven/arg.h>
 #include <aven/build.h>
 #include <aven/dl.h>
 #include <aven/fs.h>
+#include <aven/hash.h>
 #include <aven/path.h>
+#include <aven/str.h>
+#include <aven/str/builder.h>
+#include <aven/str/intern.h>
+#include <aven/str/map.h>
+#include <aven/str/rope.h>
 #include <aven/test.h>
 #include <aven/watch.h>
 
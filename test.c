@@ -1,26 +1,43 @@
-#define _POSIX_C_SOURCE 200112L
+#define _POSIX_C_SOURCE 200809L
+#define _GNU_SOURCE
 #define AVEN_IMPLEMENTATION
 
 #include <aven.h>
+#include <aven/arena.h>
+#include <aven/arena/allocator.h>
+#include <aven/arena/pool.h>
 #include <aven/fs.h>
+#include <aven/hash.h>
 #include <aven/path.h>
 #include <aven/str.h>
+#include <aven/str/builder.h>
+#include <aven/str/intern.h>
+#include <aven/str/map.h>
+#include <aven/str/rope.h>
 #include <aven/test.h>
 
 #include <stdlib.h>
 
+#include "test/arena.c"
+#include "test/fs.c"
+#include "test/hash.c"
 #include "test/path.c"
+#include "test/str.c"
 #include "test/build_common.c"
 
-#define ARENA_SIZE (4096 * 16)
+#define ARENA_SIZE (4096 * 2048)
 
 int main(void) {
     aven_fs_utf8_mode();
     void *mem = malloc(ARENA_SIZE);
-    AvenArena test_arena = aven_arena_init(mem, ARENA_SIZE);
+    AvenArena arena = aven_arena_init(mem, ARENA_SIZE);
 
-    test_path(test_arena);
-    test_build_common(test_arena);
+    test_arena(arena);
+    test_fs(arena);
+    test_hash(arena);
+    test_path(arena);
+    test_str(arena);
+    test_build_common(arena);
 
     return 0;
 }
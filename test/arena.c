@@ -0,0 +1,904 @@
+#include <aven.h>
+#include <aven/arena.h>
+#include <aven/arena/allocator.h>
+#include <aven/arena/pool.h>
+#include <aven/test.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(AVEN_ARENA_ATOMIC) and !defined(_WIN32)
+    #include <pthread.h>
+#endif
+
+#ifdef __linux__
+    typedef struct {
+        char path[256];
+        char flags[512];
+    } TestAvenArenaMapping;
+
+    // Looks up the mapping containing addr in /proc/self/smaps, its path is
+    // empty for anonymous memory and its flags are the VmFlags line
+    static bool test_aven_arena_mapping(
+        void *addr,
+        TestAvenArenaMapping *mapping
+    ) {
+        FILE *file = fopen("/proc/self/smaps", "r");
+        if (file == NULL) {
+            return false;
+        }
+
+        bool found = false;
+        bool in_mapping = false;
+        char line[512];
+        while (fgets(line, sizeof(line), file) != NULL) {
+            unsigned long start;
+            unsigned long end;
+            int fields = sscanf(
+                line,
+                "%lx-%lx %*s %*s %*s %*s %255[^\n]",
+                &start,
+                &end,
+                mapping->path
+            );
+            if (fields >= 2) {
+                in_mapping = (uintptr_t)addr >= start and
+                    (uintptr_t)addr < end;
+                if (in_mapping and fields == 2) {
+                    mapping->path[0] = 0;
+                }
+                continue;
+            }
+            if (in_mapping and strncmp(line, "VmFlags:", 8) == 0) {
+                // Pad with spaces so flags can be matched as " xx "
+                snprintf(
+                    mapping->flags,
+                    sizeof(mapping->flags),
+                    " %s",
+                    line + 8
+                );
+                size_t len = strlen(mapping->flags);
+                if (len > 0 and mapping->flags[len - 1] == '\n') {
+                    mapping->flags[len - 1] = ' ';
+                }
+                found = true;
+                break;
+            }
+        }
+
+        fclose(file);
+        return found;
+    }
+#endif
+
+AvenTestResult test_aven_arena_vm(AvenArena arena, void *args) {
+    (void)arena;
+    (void)args;
+
+    size_t reserve_size = 64 * AVEN_ARENA_VM_COMMIT_SIZE;
+    AvenArenaVmResult vm_result = aven_arena_vm_init(reserve_size);
+    if (vm_result.error != 0) {
+        return (AvenTestResult){
+            .error = vm_result.error,
+            .message = "aven_arena_vm_init failed",
+        };
+    }
+    AvenArena vm_arena = vm_result.payload;
+    unsigned char *start = vm_arena.base;
+
+    if (vm_arena.committed != vm_arena.base) {
+        aven_arena_vm_deinit(vm_arena, reserve_size);
+        return (AvenTestResult){
+            .error = 1,
+            .message = "expected nothing committed after init",
+        };
+    }
+
+#ifdef __linux__
+    // The reservation is anonymous memory without swap accounting, rather
+    // than a /dev/zero mapping
+    TestAvenArenaMapping mapping;
+    if (
+        test_aven_arena_mapping(start, &mapping) and
+        (mapping.path[0] != 0 or strstr(mapping.flags, " nr ") == NULL)
+    ) {
+        aven_arena_vm_deinit(vm_arena, reserve_size);
+        return (AvenTestResult){
+            .error = 4,
+            .message = "reservation is not an anonymous MAP_NORESERVE mapping",
+        };
+    }
+#endif
+
+    // Each allocation spans several commit chunks
+    size_t size = 3 * AVEN_ARENA_VM_COMMIT_SIZE + 100;
+    for (size_t i = 0; i < 4; i += 1) {
+        unsigned char *mem = aven_arena_alloc(&vm_arena, size, 32);
+        if (((uintptr_t)mem & 31) != 0) {
+            aven_arena_vm_deinit(vm_arena, reserve_size);
+            return (AvenTestResult){
+                .error = 2,
+                .message = "misaligned allocation",
+            };
+        }
+        memset(mem, (int)i, size);
+    }
+
+    // Copies of the arena (e.g. scratch arenas) commit on their own
+    AvenArena scratch = vm_arena;
+    unsigned char *scratch_mem = aven_arena_alloc(&scratch, size, 1);
+    memset(scratch_mem, 0xff, size);
+
+    unsigned char *mem = aven_arena_alloc(&vm_arena, size, 1);
+    memset(mem, 0xaa, size);
+
+    size_t committed = (size_t)(vm_arena.committed - start);
+    size_t max_committed = 5 * size + AVEN_ARENA_VM_COMMIT_SIZE;
+    aven_arena_vm_deinit(vm_arena, reserve_size);
+    if (committed < 5 * size or committed > max_committed) {
+        return (AvenTestResult){
+            .error = 3,
+            .message = "unexpected committed size",
+        };
+    }
+
+    return (AvenTestResult){ 0 };
+}
+
+AvenTestResult test_aven_arena_sub(AvenArena arena, void *args) {
+    (void)args;
+
+    size_t size = 4096;
+    unsigned char *base = arena.base;
+    AvenArena sub = aven_arena_sub(&arena, size);
+    if (
+        sub.top - sub.base != (ptrdiff_t)size or
+        sub.base >= base + 32 or
+        sub.top != arena.base
+    ) {
+        return (AvenTestResult){
+            .error = 1,
+            .message = "sub-arena not carved from the base of the arena",
+        };
+    }
+
+#ifdef AVEN_ARENA_ATOMIC
+    AvenArena sub_atomic = aven_arena_sub_atomic(&arena, size);
+    if (sub_atomic.base < sub.top or sub_atomic.top != arena.base) {
+        return (AvenTestResult){
+            .error = 2,
+            .message = "atomic sub-arena overlaps",
+        };
+    }
+
+    // Atomic allocations from a VM arena commit as they go
+    size_t reserve_size = 16 * AVEN_ARENA_VM_COMMIT_SIZE;
+    AvenArenaVmResult vm_result = aven_arena_vm_init(reserve_size);
+    if (vm_result.error != 0) {
+        return (AvenTestResult){
+            .error = vm_result.error,
+            .message = "aven_arena_vm_init failed",
+        };
+    }
+    AvenArena vm_arena = vm_result.payload;
+
+    unsigned char *prev = vm_arena.base;
+    for (size_t i = 0; i < 64; i += 1) {
+        size_t alloc_size = AVEN_ARENA_VM_COMMIT_SIZE / 8 + i;
+        unsigned char *mem = aven_arena_alloc_atomic(
+            &vm_arena,
+            alloc_size,
+            8
+        );
+        if (mem < prev or ((uintptr_t)mem & 7) != 0) {
+            aven_arena_vm_deinit(vm_arena, reserve_size);
+            return (AvenTestResult){
+                .error = 3,
+                .message = "bad atomic allocation",
+            };
+        }
+        memset(mem, (int)i, alloc_size);
+        prev = mem + alloc_size;
+    }
+
+    // The committed region must cover the end of the last allocation
+    bool committed = vm_arena.committed >= prev;
+    aven_arena_vm_deinit(vm_arena, reserve_size);
+    if (!committed) {
+        return (AvenTestResult){
+            .error = 4,
+            .message = "atomic allocation did not commit",
+        };
+    }
+#endif
+
+    return (AvenTestResult){ 0 };
+}
+
+#ifdef AVEN_ARENA_ATOMIC
+#define TEST_AVEN_ARENA_THREADS 4
+#define TEST_AVEN_ARENA_THREAD_ALLOCS 4096
+
+typedef struct {
+    unsigned char *ptr;
+    size_t size;
+} TestAvenArenaRange;
+
+#if defined(__GNUC__) or defined(__clang__)
+    static void test_aven_arena_thread_signal(long *ready) {
+        __atomic_add_fetch(ready, 1, __ATOMIC_ACQ_REL);
+    }
+
+    static long test_aven_arena_thread_ready(long *ready) {
+        return __atomic_load_n(ready, __ATOMIC_ACQUIRE);
+    }
+#else
+    long _InterlockedIncrement(long volatile *addend);
+    #pragma intrinsic(_InterlockedIncrement)
+
+    static void test_aven_arena_thread_signal(long *ready) {
+        _InterlockedIncrement(ready);
+    }
+
+    // Volatile accesses have acquire/release semantics on MSVC
+    static long test_aven_arena_thread_ready(long *ready) {
+        return *(long volatile *)ready;
+    }
+#endif
+
+typedef struct {
+    AvenArena *arena;
+    long *ready;
+    size_t id;
+    TestAvenArenaRange ranges[TEST_AVEN_ARENA_THREAD_ALLOCS];
+} TestAvenArenaThread;
+
+static void test_aven_arena_thread_alloc(TestAvenArenaThread *thread) {
+    // Start allocating only once every thread is running, so they contend
+    test_aven_arena_thread_signal(thread->ready);
+    while (
+        test_aven_arena_thread_ready(thread->ready) < TEST_AVEN_ARENA_THREADS
+    ) {}
+    for (size_t i = 0; i < TEST_AVEN_ARENA_THREAD_ALLOCS; i += 1) {
+        size_t size = 1 + (i * 7 + thread->id * 13) % 127;
+        unsigned char *mem = aven_arena_alloc_atomic(thread->arena, size, 8);
+        if (mem != NULL) {
+            memset(mem, (int)(thread->id + 1), size);
+        }
+        thread->ranges[i] = (TestAvenArenaRange){ .ptr = mem, .size = size };
+    }
+}
+
+#ifdef _WIN32
+    AVEN_WIN32_FN(void *) CreateThread(
+        void *attributes,
+        size_t stack_size,
+        unsigned long (__stdcall *start)(void *),
+        void *param,
+        unsigned long flags,
+        unsigned long *thread_id
+    );
+    AVEN_WIN32_FN(unsigned long) WaitForSingleObject(
+        void *handle,
+        unsigned long millis
+    );
+    AVEN_WIN32_FN(int) CloseHandle(void *handle);
+
+    static unsigned long __stdcall test_aven_arena_thread_main(void *args) {
+        test_aven_arena_thread_alloc(args);
+        return 0;
+    }
+#else
+    static void *test_aven_arena_thread_main(void *args) {
+        test_aven_arena_thread_alloc(args);
+        return NULL;
+    }
+#endif
+
+static int test_aven_arena_range_compare(const void *a, const void *b) {
+    const TestAvenArenaRange *ra = a;
+    const TestAvenArenaRange *rb = b;
+    if (ra->ptr < rb->ptr) {
+        return -1;
+    }
+    return ra->ptr > rb->ptr;
+}
+
+AvenTestResult test_aven_arena_atomic_threads(AvenArena arena, void *args) {
+    (void)args;
+
+    size_t reserve_size = 64 * AVEN_ARENA_VM_COMMIT_SIZE;
+    AvenArenaVmResult vm_result = aven_arena_vm_init(reserve_size);
+    if (vm_result.error != 0) {
+        return (AvenTestResult){
+            .error = vm_result.error,
+            .message = "aven_arena_vm_init failed",
+        };
+    }
+    AvenArena vm_arena = vm_result.payload;
+
+    TestAvenArenaThread *threads = aven_arena_create_array(
+        TestAvenArenaThread,
+        &arena,
+        TEST_AVEN_ARENA_THREADS
+    );
+    long ready = 0;
+    for (size_t i = 0; i < TEST_AVEN_ARENA_THREADS; i += 1) {
+        threads[i] = (TestAvenArenaThread){
+            .arena = &vm_arena,
+            .ready = &ready,
+            .id = i,
+        };
+    }
+
+    // Every thread races on the shared base and on committing new pages
+    size_t started = 0;
+#ifdef _WIN32
+    void *handles[TEST_AVEN_ARENA_THREADS];
+    for (; started < TEST_AVEN_ARENA_THREADS; started += 1) {
+        handles[started] = CreateThread(
+            NULL,
+            0,
+            test_aven_arena_thread_main,
+            &threads[started],
+            0,
+            NULL
+        );
+        if (handles[started] == NULL) {
+            break;
+        }
+    }
+#else
+    pthread_t handles[TEST_AVEN_ARENA_THREADS];
+    for (; started < TEST_AVEN_ARENA_THREADS; started += 1) {
+        int error = pthread_create(
+            &handles[started],
+            NULL,
+            test_aven_arena_thread_main,
+            &threads[started]
+        );
+        if (error != 0) {
+            break;
+        }
+    }
+#endif
+
+    // Release the running threads if the rest failed to start
+    for (size_t i = started; i < TEST_AVEN_ARENA_THREADS; i += 1) {
+        test_aven_arena_thread_signal(&ready);
+    }
+    for (size_t i = 0; i < started; i += 1) {
+#ifdef _WIN32
+        WaitForSingleObject(handles[i], 0xffffffff /* INFINITE */);
+        CloseHandle(handles[i]);
+#else
+        pthread_join(handles[i], NULL);
+#endif
+    }
+    if (started != TEST_AVEN_ARENA_THREADS) {
+        aven_arena_vm_deinit(vm_arena, reserve_size);
+        return (AvenTestResult){
+            .error = 1,
+            .message = "failed to start threads",
+        };
+    }
+
+    size_t count = TEST_AVEN_ARENA_THREADS * TEST_AVEN_ARENA_THREAD_ALLOCS;
+    TestAvenArenaRange *ranges = aven_arena_create_array(
+        TestAvenArenaRange,
+        &arena,
+        count
+    );
+    for (size_t i = 0; i < TEST_AVEN_ARENA_THREADS; i += 1) {
+        for (size_t j = 0; j < TEST_AVEN_ARENA_THREAD_ALLOCS; j += 1) {
+            TestAvenArenaRange range = threads[i].ranges[j];
+            ranges[i * TEST_AVEN_ARENA_THREAD_ALLOCS + j] = range;
+
+            // A range overlapping another thread's would have been
+            // partly overwritten with that thread's fill byte
+            bool intact = range.ptr != NULL;
+            for (size_t k = 0; intact and k < range.size; k += 1) {
+                intact = range.ptr[k] == (unsigned char)(i + 1);
+            }
+            if (!intact) {
+                aven_arena_vm_deinit(vm_arena, reserve_size);
+                return (AvenTestResult){
+                    .error = 2,
+                    .message = "atomic allocation clobbered",
+                };
+            }
+        }
+    }
+
+    qsort(ranges, count, sizeof(*ranges), test_aven_arena_range_compare);
+    for (size_t i = 1; i < count; i += 1) {
+        if (ranges[i - 1].ptr + ranges[i - 1].size > ranges[i].ptr) {
+            aven_arena_vm_deinit(vm_arena, reserve_size);
+            return (AvenTestResult){
+                .error = 3,
+                .message = "atomic allocations overlap",
+            };
+        }
+    }
+
+    TestAvenArenaRange last = ranges[count - 1];
+    bool committed = vm_arena.committed >= last.ptr + last.size;
+    aven_arena_vm_deinit(vm_arena, reserve_size);
+    if (!committed) {
+        return (AvenTestResult){
+            .error = 4,
+            .message = "atomic allocations not committed",
+        };
+    }
+
+    return (AvenTestResult){ 0 };
+}
+#endif
+
+AvenTestResult test_aven_arena_realloc(AvenArena arena, void *args) {
+    (void)args;
+
+    unsigned char *mem = aven_arena_alloc(&arena, 16, 8);
+    memset(mem, 0x11, 16);
+
+    // The most recent allocation grows and shrinks in place
+    if (
+        !aven_arena_resize(&arena, mem, 16, 64) or
+        aven_arena_realloc(&arena, mem, 64, 256, 8) != mem or
+        !aven_arena_resize(&arena, mem, 256, 32) or
+        arena.base != mem + 32
+    ) {
+        return (AvenTestResult){
+            .error = 1,
+            .message = "last allocation not resized in place",
+        };
+    }
+
+    unsigned char *other = aven_arena_alloc(&arena, 1, 1);
+    if (
+        aven_arena_resize(&arena, mem, 32, 64) or
+        !aven_arena_resize(&arena, mem, 32, 16)
+    ) {
+        return (AvenTestResult){
+            .error = 2,
+            .message = "earlier allocation grew in place",
+        };
+    }
+
+    unsigned char *moved = aven_arena_realloc(&arena, mem, 32, 64, 8);
+    if (
+        moved == mem or
+        moved < other or
+        moved[0] != 0x11 or
+        moved[15] != 0x11
+    ) {
+        return (AvenTestResult){
+            .error = 3,
+            .message = "realloc did not move and copy",
+        };
+    }
+
+    DynSlice(uint32_t) nums = { 0 };
+    for (uint32_t i = 0; i < 1000; i += 1) {
+        dyn_slice_push(uint32_t, nums, i, &arena);
+    }
+    unsigned char *first = (unsigned char *)nums.ptr;
+    if (
+        nums.len != 1000 or
+        nums.cap < nums.len or
+        arena.base != first + nums.cap * sizeof(uint32_t)
+    ) {
+        return (AvenTestResult){
+            .error = 4,
+            .message = "dyn_slice_push did not grow in place",
+        };
+    }
+    for (uint32_t i = 0; i < 1000; i += 1) {
+        if (slice_get(nums, i) != i) {
+            return (AvenTestResult){
+                .error = 5,
+                .message = "dyn_slice_push lost elements",
+            };
+        }
+    }
+
+#if __STDC_VERSION__ >= 201112L
+    // Elements aligned past their size's lowest set bit and past 32 bytes
+    typedef struct {
+        alignas(128) unsigned char bytes[8];
+    } TestAvenArenaLine;
+
+    aven_arena_alloc(&arena, 1, 1);
+    DynSlice(TestAvenArenaLine) lines = { 0 };
+    for (size_t i = 0; i < 20; i += 1) {
+        dyn_slice_push(
+            TestAvenArenaLine,
+            lines,
+            (TestAvenArenaLine){ .bytes = { (unsigned char)i } },
+            &arena
+        );
+        if (((uintptr_t)lines.ptr & 127) != 0) {
+            return (AvenTestResult){
+                .error = 6,
+                .message = "dyn_slice_push under-aligned elements",
+            };
+        }
+    }
+#endif
+
+    return (AvenTestResult){ 0 };
+}
+
+AvenTestResult test_aven_arena_align(AvenArena arena, void *args) {
+    (void)args;
+
+    size_t aligns[] = { 64, 1, 128, 4096, 2, AVEN_ARENA_MAX_ALIGN };
+    for (size_t i = 0; i < countof(aligns); i += 1) {
+        unsigned char *mem = aven_arena_alloc(&arena, 3, aligns[i]);
+        if (((uintptr_t)mem & (aligns[i] - 1)) != 0) {
+            return (AvenTestResult){
+                .error = 1,
+                .message = "misaligned allocation",
+            };
+        }
+    }
+
+    size_t reserve_size = 2 * AVEN_ARENA_VM_HUGE_PAGE_SIZE + 4096;
+    AvenArenaVmResult vm_result = aven_arena_vm_init_huge(reserve_size);
+    if (vm_result.error != 0) {
+        return (AvenTestResult){
+            .error = vm_result.error,
+            .message = "aven_arena_vm_init_huge failed",
+        };
+    }
+    AvenArena vm_arena = vm_result.payload;
+
+#ifndef _WIN32
+    uintptr_t huge_mask = (uintptr_t)(AVEN_ARENA_VM_HUGE_PAGE_SIZE - 1);
+    if (((uintptr_t)vm_arena.base & huge_mask) != 0) {
+        aven_arena_vm_deinit(vm_arena, reserve_size);
+        return (AvenTestResult){
+            .error = 2,
+            .message = "huge page arena not aligned to a huge page",
+        };
+    }
+#endif
+
+#ifdef __linux__
+    // Where the kernel supports transparent huge pages the advice shows up
+    // as the hg flag, which is what matters when THP is in madvise mode
+    FILE *thp_file = fopen("/sys/kernel/mm/transparent_hugepage/enabled", "r");
+    TestAvenArenaMapping mapping;
+    if (
+        thp_file != NULL and
+        test_aven_arena_mapping(vm_arena.base, &mapping) and
+        strstr(mapping.flags, " hg ") == NULL
+    ) {
+        fclose(thp_file);
+        aven_arena_vm_deinit(vm_arena, reserve_size);
+        return (AvenTestResult){
+            .error = 3,
+            .message = "MADV_HUGEPAGE not applied to the huge page arena",
+        };
+    }
+    if (thp_file != NULL) {
+        fclose(thp_file);
+    }
+#endif
+
+    size_t size = (size_t)(vm_arena.top - vm_arena.base);
+    unsigned char *mem = aven_arena_alloc(&vm_arena, size, 64);
+    memset(mem, 0x5a, size);
+    aven_arena_vm_deinit(vm_arena, reserve_size);
+
+    return (AvenTestResult){ 0 };
+}
+
+typedef struct {
+    unsigned char bytes[40];
+} TestAvenArenaPoolItem;
+
+AvenTestResult test_aven_arena_pool(AvenArena arena, void *args) {
+    (void)args;
+
+    TestAvenArenaPoolItem *items[3 * AVEN_ARENA_POOL_CHUNK_LEN];
+    AvenArenaPool pool = aven_arena_pool_init(
+        sizeof(TestAvenArenaPoolItem),
+        64
+    );
+
+    // Alloc/free cycles reuse the same slots once the pool has grown
+    unsigned char *base = NULL;
+    for (size_t cycle = 0; cycle < 4; cycle += 1) {
+        for (size_t i = 0; i < countof(items); i += 1) {
+            items[i] = aven_arena_pool_create(
+                TestAvenArenaPoolItem,
+                &pool,
+                &arena
+            );
+            if (((uintptr_t)items[i] & 63) != 0) {
+                return (AvenTestResult){
+                    .error = 1,
+                    .message = "misaligned pool slot",
+                };
+            }
+            memset(items[i], (int)i, sizeof(*items[i]));
+        }
+        for (size_t i = 0; i < countof(items); i += 1) {
+            if (items[i]->bytes[39] != (unsigned char)i) {
+                return (AvenTestResult){
+                    .error = 2,
+                    .message = "pool slots overlap",
+                };
+            }
+            aven_arena_pool_free(&pool, items[i]);
+        }
+        if (base != NULL and arena.base != base) {
+            return (AvenTestResult){
+                .error = 3,
+                .message = "pool grew after freeing every slot",
+            };
+        }
+        base = arena.base;
+    }
+
+#ifdef AVEN_ARENA_ATOMIC
+    // Slots freed through one cache spill to the pool and refill another
+    AvenArenaPool shared = aven_arena_pool_init_type(TestAvenArenaPoolItem);
+    AvenArenaPoolCache cache_a = aven_arena_pool_cache_init(&shared);
+    AvenArenaPoolCache cache_b = aven_arena_pool_cache_init(&shared);
+    for (size_t i = 0; i < countof(items); i += 1) {
+        items[i] = aven_arena_pool_cache_alloc(&cache_a, &arena);
+    }
+    for (size_t i = 0; i < countof(items); i += 1) {
+        aven_arena_pool_cache_free(&cache_a, items[i]);
+    }
+
+    // Frees spill in fixed batches, leaving at most a partial batch cached
+    if (
+        cache_a.spill_len >= AVEN_ARENA_POOL_CHUNK_LEN or
+        cache_a.spill_len != countof(items) % AVEN_ARENA_POOL_CHUNK_LEN or
+        shared.free == NULL
+    ) {
+        return (AvenTestResult){
+            .error = 5,
+            .message = "pool cache did not spill a fixed batch",
+        };
+    }
+    aven_arena_pool_cache_flush(&cache_a);
+
+    base = arena.base;
+    for (size_t i = 0; i < countof(items); i += 1) {
+        items[i] = aven_arena_pool_cache_alloc(&cache_b, &arena);
+    }
+    if (
+        arena.base != base or
+        cache_a.free != NULL or
+        cache_a.spill != NULL
+    ) {
+        return (AvenTestResult){
+            .error = 4,
+            .message = "pool cache did not reuse spilled slots",
+        };
+    }
+#endif
+
+    return (AvenTestResult){ 0 };
+}
+
+AvenTestResult test_aven_arena_allocator(AvenArena arena, void *args) {
+    (void)args;
+
+    AvenArenaAllocator allocator = aven_arena_allocator(&arena);
+    unsigned char *base = arena.base;
+
+    unsigned char *a = allocator.alloc(allocator.ctx, 10);
+    memset(a, 0x22, 10);
+    unsigned char *b = allocator.alloc(allocator.ctx, 3);
+    if (
+        ((uintptr_t)a & (AVEN_ARENA_ALLOCATOR_ALIGN - 1)) != 0 or
+        ((uintptr_t)b & (AVEN_ARENA_ALLOCATOR_ALIGN - 1)) != 0
+    ) {
+        return (AvenTestResult){
+            .error = 1,
+            .message = "misaligned allocation",
+        };
+    }
+
+    // The most recent block grows in place, earlier blocks are copied
+    if (allocator.realloc(allocator.ctx, b, 1000) != b) {
+        return (AvenTestResult){
+            .error = 2,
+            .message = "last block not grown in place",
+        };
+    }
+    unsigned char *c = allocator.realloc(allocator.ctx, a, 20);
+    if (c == a or c[0] != 0x22 or c[9] != 0x22) {
+        return (AvenTestResult){
+            .error = 3,
+            .message = "realloc did not copy",
+        };
+    }
+
+    // Freeing in LIFO order returns the space
+    allocator.free(allocator.ctx, c);
+    allocator.free(allocator.ctx, b);
+    allocator.free(allocator.ctx, a);
+    allocator.free(allocator.ctx, NULL);
+    if (arena.base - base >= AVEN_ARENA_ALLOCATOR_ALIGN) {
+        return (AvenTestResult){
+            .error = 4,
+            .message = "LIFO free did not return the space",
+        };
+    }
+
+    size_t available = (size_t)(arena.top - arena.base);
+    if (allocator.alloc(allocator.ctx, available) != NULL) {
+        return (AvenTestResult){
+            .error = 5,
+            .message = "expected NULL when the arena is full",
+        };
+    }
+
+    // A small arena at a misaligned base, where the padding, header, and
+    // rounding up of the size together decide what still fits
+    unsigned char *small_mem = aven_arena_alloc(
+        &arena,
+        100 + AVEN_ARENA_ALLOCATOR_ALIGN,
+        AVEN_ARENA_ALLOCATOR_ALIGN
+    );
+    AvenArena small_arena = aven_arena_init(small_mem + 5, 100);
+    AvenArenaAllocator small = aven_arena_allocator(&small_arena);
+    if (
+        small.alloc(small.ctx, 68) != NULL or
+        small.alloc(small.ctx, SIZE_MAX) != NULL or
+        small.alloc(small.ctx, SIZE_MAX - 20) != NULL
+    ) {
+        return (AvenTestResult){
+            .error = 6,
+            .message = "expected NULL for blocks that do not fit",
+        };
+    }
+    unsigned char *fit = small.alloc(small.ctx, 64);
+    if (
+        fit == NULL or
+        fit + 64 > small_arena.top or
+        small.realloc(small.ctx, fit, SIZE_MAX - 20) != NULL
+    ) {
+        return (AvenTestResult){
+            .error = 7,
+            .message = "largest block did not fit exactly",
+        };
+    }
+
+    return (AvenTestResult){ 0 };
+}
+
+#ifdef AVEN_ARENA_STATS
+static AvenArenaStatsSite *test_aven_arena_stats_site(int line) {
+    AvenArenaStats *stats = aven_arena_stats();
+    for (size_t i = 0; i < AVEN_ARENA_STATS_MAX_SITES; i += 1) {
+        AvenArenaStatsSite *site = &stats->sites[i];
+        if (site->file == NULL or strcmp(site->file, __FILE__) != 0) {
+            continue;
+        }
+        if (site->line == line) {
+            return site;
+        }
+    }
+    return NULL;
+}
+
+AvenTestResult test_aven_arena_stats(AvenArena arena, void *args) {
+    (void)args;
+
+    aven_arena_alloc(&arena, 0, 8);
+    for (size_t i = 0; i < 3; i += 1) {
+        aven_arena_alloc(&arena, 5, 8);
+    }
+    int alloc_line = __LINE__ - 2;
+
+    void *mem = NULL;
+    for (size_t i = 0; i < 2; i += 1) {
+        mem = aven_arena_realloc(&arena, mem, i * 16, (i + 1) * 16, 8);
+    }
+    int realloc_line = __LINE__ - 2;
+
+    DynSlice(uint32_t) nums = { 0 };
+    for (uint32_t i = 0; i < 20; i += 1) {
+        dyn_slice_push(uint32_t, nums, i, &arena);
+    }
+    int push_line = __LINE__ - 2;
+
+    AvenArenaStatsSite *alloc_site = test_aven_arena_stats_site(alloc_line);
+    AvenArenaStatsSite *realloc_site = test_aven_arena_stats_site(
+        realloc_line
+    );
+    AvenArenaStatsSite *push_site = test_aven_arena_stats_site(push_line);
+    if (alloc_site == NULL or realloc_site == NULL or push_site == NULL) {
+        return (AvenTestResult){
+            .error = 2,
+            .message = "call site not recorded",
+        };
+    }
+
+    if (
+        alloc_site->count != 3 or
+        alloc_site->bytes != 15 or
+        alloc_site->padding != 6
+    ) {
+        return (AvenTestResult){
+            .error = 1,
+            .message = "unexpected call site statistics",
+        };
+    }
+
+    // The second realloc grows in place, so it only adds 16 bytes
+    if (realloc_site->count != 2 or realloc_site->bytes != 32) {
+        return (AvenTestResult){
+            .error = 3,
+            .message = "unexpected aven_arena_realloc call site statistics",
+        };
+    }
+
+    // Grows to 8, 16, then 32 elements, in place after the first
+    if (push_site->count != 3 or push_site->bytes != 32 * sizeof(uint32_t)) {
+        return (AvenTestResult){
+            .error = 4,
+            .message = "unexpected dyn_slice_push call site statistics",
+        };
+    }
+
+    return (AvenTestResult){ 0 };
+}
+#endif
+
+int test_arena(AvenArena arena) {
+    AvenTestCase tcase_data[] = {
+        {
+            .desc = "aven_arena_vm commits on demand",
+            .fn = test_aven_arena_vm,
+        },
+        {
+            .desc = "aven_arena_sub and atomic allocation",
+            .fn = test_aven_arena_sub,
+        },
+#ifdef AVEN_ARENA_ATOMIC
+        {
+            .desc = "aven_arena_alloc_atomic is disjoint under contention",
+            .fn = test_aven_arena_atomic_threads,
+        },
+#endif
+        {
+            .desc = "aven_arena_realloc grows the last allocation in place",
+            .fn = test_aven_arena_realloc,
+        },
+        {
+            .desc = "aven_arena_alloc large alignments and huge pages",
+            .fn = test_aven_arena_align,
+        },
+        {
+            .desc = "aven_arena_pool reuses freed slots",
+            .fn = test_aven_arena_pool,
+        },
+        {
+            .desc = "aven_arena_allocator malloc compatible adapter",
+            .fn = test_aven_arena_allocator,
+        },
+#ifdef AVEN_ARENA_STATS
+        {
+            .desc = "aven_arena_stats records call sites",
+            .fn = test_aven_arena_stats,
+        },
+#endif
+    };
+    AvenTestCaseSlice tcases = {
+        .ptr = tcase_data,
+        .len = countof(tcase_data),
+    };
+
+    aven_test(tcases, __FILE__, arena);
+
+    return 0;
+}
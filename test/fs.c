@@ -0,0 +1,885 @@
+#include <aven.h>
+#include <aven/fs.h>
+#include <aven/str.h>
+#include <aven/test.h>
+
+#include <stdio.h>
+#include <string.h>
+
+#ifndef _WIN32
+    #include <fcntl.h>
+    #include <pthread.h>
+    #include <sys/stat.h>
+#endif
+
+typedef struct {
+    char *path;
+    size_t size;
+} TestAvenFsMapArgs;
+
+static unsigned char test_aven_fs_byte(size_t i) {
+    return (unsigned char)((i * 31 + (i >> 8)) & 0xff);
+}
+
+AvenTestResult test_aven_fs_map(AvenArena arena, void *args) {
+    TestAvenFsMapArgs *pargs = args;
+
+    FILE *file = fopen(pargs->path, "wb");
+    if (file == NULL) {
+        return (AvenTestResult){
+            .error = 1,
+            .message = "failed to create test file",
+        };
+    }
+    for (size_t i = 0; i < pargs->size; i += 1) {
+        fputc(test_aven_fs_byte(i), file);
+    }
+    fclose(file);
+
+    AvenFsMapResult result = aven_fs_map(aven_str_cstr(pargs->path), &arena);
+    aven_fs_rm(aven_str_cstr(pargs->path));
+    if (result.error != 0) {
+        return (AvenTestResult){
+            .error = result.error,
+            .message = "aven_fs_map failed",
+        };
+    }
+
+    AvenFsMap map = result.payload;
+    AvenTestResult test_result = { 0 };
+    if (map.bytes.len != pargs->size) {
+        test_result = (AvenTestResult){
+            .error = 2,
+            .message = "mapped length does not match file size",
+        };
+    } else {
+        for (size_t i = 0; i < map.bytes.len; i += 1) {
+            if (slice_get(map.bytes, i) != test_aven_fs_byte(i)) {
+                test_result = (AvenTestResult){
+                    .error = 3,
+                    .message = "mapped bytes do not match file contents",
+                };
+                break;
+            }
+        }
+    }
+
+    aven_fs_unmap(map);
+
+    return test_result;
+}
+
+AvenTestResult test_aven_fs_map_missing(AvenArena arena, void *args) {
+    (void)args;
+
+    AvenFsMapResult result = aven_fs_map(
+        aven_str("aven_test_fs_missing_file"),
+        &arena
+    );
+    if (result.error != AVEN_FS_MAP_ERROR_OPEN) {
+        return (AvenTestResult){
+            .error = 1,
+            .message = "expected AVEN_FS_MAP_ERROR_OPEN",
+        };
+    }
+
+    return (AvenTestResult){ 0 };
+}
+
+#ifdef __linux__
+AvenTestResult test_aven_fs_read_proc(AvenArena arena, void *args) {
+    (void)args;
+
+    // procfs reports a size of 0 for files that do have contents
+    AvenStr path = aven_str("/proc/self/status");
+    AvenFsReadResult read_result = aven_fs_read(path, &arena);
+    if (read_result.error != 0 or read_result.payload.len == 0) {
+        return (AvenTestResult){
+            .error = 1,
+            .message = "aven_fs_read returned an empty procfs file",
+        };
+    }
+
+    AvenFsMapResult map_result = aven_fs_map(path, &arena);
+    if (map_result.error != 0 or map_result.payload.bytes.len == 0) {
+        return (AvenTestResult){
+            .error = 2,
+            .message = "aven_fs_map returned an empty procfs file",
+        };
+    }
+    aven_fs_unmap(map_result.payload);
+
+    return (AvenTestResult){ 0 };
+}
+#endif
+
+typedef struct {
+    char *path;
+    char *contents[2];
+} TestAvenFsWriteArgs;
+
+AvenTestResult test_aven_fs_write_atomic(AvenArena arena, void *args) {
+    TestAvenFsWriteArgs *pargs = args;
+    AvenStr path = aven_str_cstr(pargs->path);
+
+    for (size_t i = 0; i < countof(pargs->contents); i += 1) {
+        AvenStr contents = aven_str_cstr(pargs->contents[i]);
+        int error = aven_fs_write_atomic(path, slice_as_bytes(contents));
+        if (error != 0) {
+            aven_fs_rm(path);
+            return (AvenTestResult){
+                .error = error,
+                .message = "aven_fs_write_atomic failed",
+            };
+        }
+
+        AvenFsReadResult result = aven_fs_read(path, &arena);
+        if (result.error != 0) {
+            aven_fs_rm(path);
+            return (AvenTestResult){
+                .error = result.error,
+                .message = "aven_fs_read failed",
+            };
+        }
+
+        AvenStr read_contents = {
+            .ptr = (char *)result.payload.ptr,
+            .len = result.payload.len,
+        };
+        if (!aven_str_compare(read_contents, contents)) {
+            aven_fs_rm(path);
+            return (AvenTestResult){
+                .error = 1,
+                .message = "read contents do not match written contents",
+            };
+        }
+    }
+
+    int error = aven_fs_rm(path);
+    if (error != 0) {
+        return (AvenTestResult){
+            .error = error,
+            .message = "failed to remove written file",
+        };
+    }
+
+    return (AvenTestResult){ 0 };
+}
+
+#ifndef _WIN32
+AvenTestResult test_aven_fs_write_atomic_mode(AvenArena arena, void *args) {
+    (void)arena;
+    (void)args;
+
+    AvenStr path = aven_str("aven_test_fs_write_atomic_mode");
+    int error = aven_fs_write_atomic(path, slice_as_bytes(aven_str("a\n")));
+    if (error != 0) {
+        return (AvenTestResult){
+            .error = error,
+            .message = "aven_fs_write_atomic failed",
+        };
+    }
+    chmod(path.ptr, S_IRWXU | S_IRGRP | S_IXGRP);
+
+    // Replacing an executable must not drop its permission bits
+    error = aven_fs_write_atomic(path, slice_as_bytes(aven_str("b\n")));
+    struct stat info;
+    bool found = stat(path.ptr, &info) == 0;
+    aven_fs_rm(path);
+    if (error != 0) {
+        return (AvenTestResult){
+            .error = error,
+            .message = "aven_fs_write_atomic replace failed",
+        };
+    }
+    if (
+        !found or
+        (info.st_mode & (S_IRWXU | S_IRWXG | S_IRWXO)) !=
+            (S_IRWXU | S_IRGRP | S_IXGRP)
+    ) {
+        return (AvenTestResult){
+            .error = 1,
+            .message = "aven_fs_write_atomic changed the file mode",
+        };
+    }
+
+    return (AvenTestResult){ 0 };
+}
+
+#define TEST_AVEN_FS_WRITE_THREADS 4
+#define TEST_AVEN_FS_THREAD_WRITES 32
+
+typedef struct {
+    AvenStr path;
+    AvenStr contents;
+    int error;
+} TestAvenFsWriteThread;
+
+static void *test_aven_fs_write_thread_main(void *args) {
+    TestAvenFsWriteThread *thread = args;
+    for (size_t i = 0; i < TEST_AVEN_FS_THREAD_WRITES; i += 1) {
+        int error = aven_fs_write_atomic(
+            thread->path,
+            slice_as_bytes(thread->contents)
+        );
+        if (error != 0) {
+            thread->error = error;
+        }
+    }
+    return NULL;
+}
+
+AvenTestResult test_aven_fs_write_atomic_threads(
+    AvenArena arena,
+    void *args
+) {
+    (void)args;
+
+    // Threads writing the same path must not share a temporary file
+    AvenStr path = aven_str("aven_test_fs_write_atomic_threads");
+    TestAvenFsWriteThread threads[TEST_AVEN_FS_WRITE_THREADS];
+    pthread_t handles[TEST_AVEN_FS_WRITE_THREADS];
+    char *contents[TEST_AVEN_FS_WRITE_THREADS] = {
+        "zero",
+        "one",
+        "two",
+        "three",
+    };
+    size_t started = 0;
+    for (; started < TEST_AVEN_FS_WRITE_THREADS; started += 1) {
+        threads[started] = (TestAvenFsWriteThread){
+            .path = path,
+            .contents = aven_str_cstr(contents[started]),
+        };
+        int error = pthread_create(
+            &handles[started],
+            NULL,
+            test_aven_fs_write_thread_main,
+            &threads[started]
+        );
+        if (error != 0) {
+            break;
+        }
+    }
+
+    AvenTestResult result = { 0 };
+    for (size_t i = 0; i < started; i += 1) {
+        pthread_join(handles[i], NULL);
+        if (threads[i].error != 0 and result.error == 0) {
+            result = (AvenTestResult){
+                .error = threads[i].error,
+                .message = "concurrent aven_fs_write_atomic failed",
+            };
+        }
+    }
+    if (started != TEST_AVEN_FS_WRITE_THREADS and result.error == 0) {
+        result = (AvenTestResult){
+            .error = 1,
+            .message = "failed to start threads",
+        };
+    }
+
+    AvenFsReadResult read_result = aven_fs_read(path, &arena);
+    aven_fs_rm(path);
+    if (result.error != 0) {
+        return result;
+    }
+    if (read_result.error != 0) {
+        return (AvenTestResult){
+            .error = 2,
+            .message = "aven_fs_read failed",
+        };
+    }
+
+    AvenStr read_contents = {
+        .ptr = (char *)read_result.payload.ptr,
+        .len = read_result.payload.len,
+    };
+    for (size_t i = 0; i < TEST_AVEN_FS_WRITE_THREADS; i += 1) {
+        if (aven_str_compare(read_contents, threads[i].contents)) {
+            return (AvenTestResult){ 0 };
+        }
+    }
+
+    return (AvenTestResult){
+        .error = 3,
+        .message = "file does not match any complete write",
+    };
+}
+#endif
+
+AvenTestResult test_aven_fs_read_missing(AvenArena arena, void *args) {
+    (void)args;
+
+    AvenFsReadResult result = aven_fs_read(
+        aven_str("aven_test_fs_missing_file"),
+        &arena
+    );
+    if (result.error != AVEN_FS_READ_ERROR_OPEN) {
+        return (AvenTestResult){
+            .error = 1,
+            .message = "expected AVEN_FS_READ_ERROR_OPEN",
+        };
+    }
+
+    return (AvenTestResult){ 0 };
+}
+
+AvenTestResult test_aven_fs_hash(AvenArena arena, void *args) {
+    (void)args;
+
+    AvenStr path = aven_str("aven_test_fs_hash");
+    ByteSlice contents = { .len = AVEN_FS_HASH_BUFFER_SIZE + 3 * 1024 + 7 };
+    contents.ptr = aven_arena_alloc(&arena, contents.len, 1);
+    for (size_t i = 0; i < contents.len; i += 1) {
+        slice_get(contents, i) = test_aven_fs_byte(i);
+    }
+
+    int error = aven_fs_write_atomic(path, contents);
+    if (error != 0) {
+        return (AvenTestResult){
+            .error = error,
+            .message = "aven_fs_write_atomic failed",
+        };
+    }
+
+    AvenFsHashResult result = aven_fs_hash(path, 7, arena);
+    aven_fs_rm(path);
+    if (result.error != 0) {
+        return (AvenTestResult){
+            .error = result.error,
+            .message = "aven_fs_hash failed",
+        };
+    }
+
+    if (!aven_hash_eq(result.payload, aven_hash(contents, 7))) {
+        return (AvenTestResult){
+            .error = 1,
+            .message = "aven_fs_hash differs from aven_hash of contents",
+        };
+    }
+
+    result = aven_fs_hash(aven_str("aven_test_fs_missing_file"), 7, arena);
+    if (result.error != AVEN_FS_HASH_ERROR_OPEN) {
+        return (AvenTestResult){
+            .error = 2,
+            .message = "expected AVEN_FS_HASH_ERROR_OPEN",
+        };
+    }
+
+    return (AvenTestResult){ 0 };
+}
+
+AvenTestResult test_aven_fs_stat_cache(AvenArena arena, void *args) {
+    (void)args;
+
+    AvenStr path = aven_str("aven_test_fs_stat_cache");
+    int error = aven_fs_write_atomic(path, slice_as_bytes(aven_str("abc")));
+    if (error != 0) {
+        return (AvenTestResult){
+            .error = error,
+            .message = "aven_fs_write_atomic failed",
+        };
+    }
+
+    AvenFsStatCache cache = aven_fs_stat_cache_init(0, &arena);
+
+    // Enough filler entries to force the table to grow
+    for (size_t i = 0; i < 40; i += 1) {
+        char name[] = "aven_test_fs_stat_cache_missing_00";
+        name[sizeof(name) - 3] = (char)('0' + i / 10);
+        name[sizeof(name) - 2] = (char)('0' + i % 10);
+        AvenFsStatResult result = aven_fs_stat_cache_get(
+            &cache,
+            aven_str_cstr(name),
+            &arena
+        );
+        if (result.error != AVEN_FS_STAT_ERROR_BADPATH) {
+            aven_fs_rm(path);
+            return (AvenTestResult){
+                .error = 1,
+                .message = "expected AVEN_FS_STAT_ERROR_BADPATH",
+            };
+        }
+    }
+
+    AvenFsStatResult result = aven_fs_stat_cache_get(&cache, path, &arena);
+    if (result.error != 0 or result.payload.size != 3) {
+        aven_fs_rm(path);
+        return (AvenTestResult){
+            .error = 2,
+            .message = "unexpected stat result",
+        };
+    }
+
+    error = aven_fs_write_atomic(path, slice_as_bytes(aven_str("abcdef")));
+    if (error != 0) {
+        aven_fs_rm(path);
+        return (AvenTestResult){
+            .error = error,
+            .message = "aven_fs_write_atomic failed",
+        };
+    }
+
+    result = aven_fs_stat_cache_get(&cache, path, &arena);
+    if (result.error != 0 or result.payload.size != 3) {
+        aven_fs_rm(path);
+        return (AvenTestResult){
+            .error = 3,
+            .message = "expected stale cached stat result",
+        };
+    }
+
+    aven_fs_stat_cache_invalidate_dir(&cache, aven_str("aven_test_fs"));
+    result = aven_fs_stat_cache_get(&cache, path, &arena);
+    if (result.error != 0 or result.payload.size != 3) {
+        aven_fs_rm(path);
+        return (AvenTestResult){
+            .error = 4,
+            .message = "invalidate_dir matched a non-directory prefix",
+        };
+    }
+
+    aven_fs_stat_cache_invalidate(&cache, path);
+    result = aven_fs_stat_cache_get(&cache, path, &arena);
+    aven_fs_rm(path);
+    if (result.error != 0 or result.payload.size != 6) {
+        return (AvenTestResult){
+            .error = 5,
+            .message = "expected updated stat result after invalidate",
+        };
+    }
+
+    if (cache.map.len != 41) {
+        return (AvenTestResult){
+            .error = 6,
+            .message = "unexpected number of cache entries",
+        };
+    }
+
+    return (AvenTestResult){ 0 };
+}
+
+AvenTestResult test_aven_fs_batch(AvenArena arena, void *args) {
+    (void)args;
+
+    AvenStr dir_path = aven_str("aven_test_fs_batch");
+    AvenStr src_path = aven_str("aven_test_fs_batch_src");
+
+    ByteSlice contents = { .len = 3 * AVEN_FS_BATCH_COPY_BUFFER_SIZE + 5 };
+    contents.ptr = aven_arena_alloc(&arena, contents.len, 1);
+    for (size_t i = 0; i < contents.len; i += 1) {
+        slice_get(contents, i) = test_aven_fs_byte(i);
+    }
+    int error = aven_fs_write_atomic(src_path, contents);
+    if (error != 0) {
+        return (AvenTestResult){
+            .error = error,
+            .message = "aven_fs_write_atomic failed",
+        };
+    }
+
+    AvenFsBatchOp mkdir_ops[] = {
+        aven_fs_batch_op_mkdir(dir_path),
+    };
+    error = aven_fs_batch(
+        (AvenFsBatchOpSlice){ .ptr = mkdir_ops, .len = countof(mkdir_ops) },
+        arena
+    );
+    if (error != 0) {
+        aven_fs_rm(src_path);
+        return (AvenTestResult){
+            .error = error,
+            .message = "batch mkdir failed",
+        };
+    }
+
+    // More ops than AVEN_FS_BATCH_MAX_INFLIGHT to exercise slot reuse
+    size_t ncopies = AVEN_FS_BATCH_MAX_INFLIGHT + 3;
+    AvenStrSlice copy_paths = { .len = ncopies };
+    copy_paths.ptr = aven_arena_create_array(AvenStr, &arena, ncopies);
+    AvenFsBatchOpSlice ops = { .len = ncopies + 4 };
+    ops.ptr = aven_arena_create_array(AvenFsBatchOp, &arena, ops.len);
+    for (size_t i = 0; i < ncopies; i += 1) {
+        char name[] = "aven_test_fs_batch/copy_00";
+        name[sizeof(name) - 3] = (char)('0' + i / 10);
+        name[sizeof(name) - 2] = (char)('0' + i % 10);
+        slice_get(copy_paths, i) = aven_str_copy(aven_str_cstr(name), &arena);
+        slice_get(ops, i) = aven_fs_batch_op_copy(
+            src_path,
+            slice_get(copy_paths, i)
+        );
+    }
+    AvenStr trunc_path = aven_str("aven_test_fs_batch/trunc");
+    slice_get(ops, ncopies) = aven_fs_batch_op_trunc(trunc_path);
+    slice_get(ops, ncopies + 1) = aven_fs_batch_op_stat(src_path);
+    slice_get(ops, ncopies + 2) = aven_fs_batch_op_copy(
+        aven_str("aven_test_fs_missing_file"),
+        aven_str("aven_test_fs_batch/missing")
+    );
+    slice_get(ops, ncopies + 3) = aven_fs_batch_op_mkdir(dir_path);
+
+    error = aven_fs_batch(ops, arena);
+
+    AvenTestResult result = { 0 };
+    if (error != AVEN_FS_BATCH_ERROR_OP) {
+        result = (AvenTestResult){
+            .error = 1,
+            .message = "expected AVEN_FS_BATCH_ERROR_OP",
+        };
+    } else if (slice_get(ops, ncopies + 2).error != AVEN_FS_COPY_ERROR_IFOPEN) {
+        result = (AvenTestResult){
+            .error = 2,
+            .message = "expected AVEN_FS_COPY_ERROR_IFOPEN",
+        };
+    } else if (slice_get(ops, ncopies + 3).error != AVEN_FS_MKDIR_ERROR_EXIST) {
+        result = (AvenTestResult){
+            .error = 3,
+            .message = "expected AVEN_FS_MKDIR_ERROR_EXIST",
+        };
+    } else if (
+        slice_get(ops, ncopies + 1).error != 0 or
+        slice_get(ops, ncopies + 1).stat.size != contents.len
+    ) {
+        result = (AvenTestResult){
+            .error = 4,
+            .message = "unexpected batch stat result",
+        };
+    }
+
+    for (size_t i = 0; i < ncopies and result.error == 0; i += 1) {
+        if (slice_get(ops, i).error != 0) {
+            result = (AvenTestResult){
+                .error = 5,
+                .message = "batch copy failed",
+            };
+            break;
+        }
+
+        AvenArena temp_arena = arena;
+        AvenFsReadResult read_result = aven_fs_read(
+            slice_get(copy_paths, i),
+            &temp_arena
+        );
+        if (
+            read_result.error != 0 or
+            read_result.payload.len != contents.len or
+            memcmp(read_result.payload.ptr, contents.ptr, contents.len) != 0
+        ) {
+            result = (AvenTestResult){
+                .error = 6,
+                .message = "batch copy contents do not match",
+            };
+        }
+    }
+
+    for (size_t i = 0; i < ncopies; i += 1) {
+        slice_get(ops, i) = aven_fs_batch_op_rm(slice_get(copy_paths, i));
+    }
+    slice_get(ops, ncopies) = aven_fs_batch_op_rm(trunc_path);
+    ops.len = ncopies + 1;
+    error = aven_fs_batch(ops, arena);
+    aven_fs_rmdir(dir_path);
+    aven_fs_rm(src_path);
+    if (error != 0 and result.error == 0) {
+        result = (AvenTestResult){
+            .error = 7,
+            .message = "batch rm failed",
+        };
+    }
+
+    return result;
+}
+
+static AvenTestResult test_aven_fs_dir_ops(AvenFsDir dir, AvenFsDir sub) {
+    AvenStr sub_name = aven_str("sub");
+    AvenStr src_name = aven_str("src");
+    AvenStr dst_name = aven_str("dst");
+
+    int error = aven_fs_write_atomic(
+        aven_str("aven_test_fs_dir/src"),
+        slice_as_bytes(aven_str("abc"))
+    );
+    if (error == 0) {
+        error = aven_fs_dir_copy(dir, src_name, sub, dst_name);
+    }
+    if (error != 0) {
+        return (AvenTestResult){
+            .error = 3,
+            .message = "aven_fs_dir_copy failed",
+        };
+    }
+
+    AvenFsStatResult stat_result = aven_fs_dir_stat(sub, dst_name);
+    if (stat_result.error != 0 or stat_result.payload.size != 3) {
+        return (AvenTestResult){
+            .error = 4,
+            .message = "unexpected aven_fs_dir_stat result",
+        };
+    }
+
+    error = aven_fs_dir_trunc(sub, dst_name);
+    stat_result = aven_fs_dir_stat(sub, dst_name);
+    if (
+        error != 0 or
+        stat_result.error != 0 or
+        stat_result.payload.size != 0
+    ) {
+        return (AvenTestResult){
+            .error = 5,
+            .message = "aven_fs_dir_trunc failed",
+        };
+    }
+
+    error = aven_fs_dir_rmdir(dir, sub_name);
+    if (error != AVEN_FS_RMDIR_ERROR_NOTEMPTY) {
+        return (AvenTestResult){
+            .error = 6,
+            .message = "expected AVEN_FS_RMDIR_ERROR_NOTEMPTY",
+        };
+    }
+
+    stat_result = aven_fs_dir_stat(dir, aven_str("missing"));
+    if (stat_result.error != AVEN_FS_STAT_ERROR_BADPATH) {
+        return (AvenTestResult){
+            .error = 7,
+            .message = "expected AVEN_FS_STAT_ERROR_BADPATH",
+        };
+    }
+
+    return (AvenTestResult){ 0 };
+}
+
+AvenTestResult test_aven_fs_dir(AvenArena arena, void *args) {
+    (void)arena;
+    (void)args;
+
+    AvenStr dir_path = aven_str("aven_test_fs_dir");
+    int error = aven_fs_mkdir(dir_path);
+    if (error != 0) {
+        return (AvenTestResult){
+            .error = error,
+            .message = "aven_fs_mkdir failed",
+        };
+    }
+
+    AvenFsDirResult dir_result = aven_fs_dir_open(dir_path);
+    if (dir_result.error != 0) {
+        aven_fs_rmdir(dir_path);
+        return (AvenTestResult){
+            .error = dir_result.error,
+            .message = "aven_fs_dir_open failed",
+        };
+    }
+    AvenFsDir dir = dir_result.payload;
+
+    AvenTestResult result = { 0 };
+    AvenStr sub_name = aven_str("sub");
+
+    error = aven_fs_dir_mkdir(dir, sub_name);
+    if (error != 0) {
+        result = (AvenTestResult){
+            .error = 1,
+            .message = "aven_fs_dir_mkdir failed",
+        };
+    }
+
+    if (result.error == 0) {
+        AvenFsDirResult sub_result = aven_fs_dir_open(
+            aven_str("aven_test_fs_dir/sub")
+        );
+        if (sub_result.error != 0) {
+            result = (AvenTestResult){
+                .error = 2,
+                .message = "aven_fs_dir_open subdirectory failed",
+            };
+        } else {
+            AvenFsDir sub = sub_result.payload;
+            result = test_aven_fs_dir_ops(dir, sub);
+            aven_fs_dir_rm(sub, aven_str("dst"));
+            aven_fs_dir_close(sub);
+        }
+    }
+
+    aven_fs_dir_rm(dir, aven_str("src"));
+    aven_fs_dir_rmdir(dir, sub_name);
+    aven_fs_dir_close(dir);
+    error = aven_fs_rmdir(dir_path);
+    if (error != 0 and result.error == 0) {
+        result = (AvenTestResult){
+            .error = 8,
+            .message = "aven_fs_dir cleanup failed",
+        };
+    }
+
+    return result;
+}
+
+#ifdef O_PATH
+AvenTestResult test_aven_fs_dir_noread(AvenArena arena, void *args) {
+    (void)arena;
+    (void)args;
+
+    AvenStr dir_path = aven_str("aven_test_fs_dir_noread");
+    int error = aven_fs_mkdir(dir_path);
+    if (error != 0) {
+        return (AvenTestResult){
+            .error = error,
+            .message = "aven_fs_mkdir failed",
+        };
+    }
+    chmod(dir_path.ptr, S_IWUSR | S_IXUSR);
+
+    // A directory that can be searched but not listed still opens, and
+    // names can be created and removed relative to it
+    AvenTestResult result = { 0 };
+    AvenFsDirResult dir_result = aven_fs_dir_open(dir_path);
+    if (dir_result.error != 0) {
+        result = (AvenTestResult){
+            .error = 1,
+            .message = "aven_fs_dir_open failed on a -wx directory",
+        };
+    } else {
+        AvenFsDir dir = dir_result.payload;
+        AvenStr name = aven_str("file");
+        error = aven_fs_dir_trunc(dir, name);
+        AvenFsStatResult stat_result = aven_fs_dir_stat(dir, name);
+        if (error != 0 or stat_result.error != 0) {
+            result = (AvenTestResult){
+                .error = 2,
+                .message = "aven_fs_dir ops failed on a -wx directory",
+            };
+        }
+        if (aven_fs_dir_rm(dir, name) != 0 and result.error == 0) {
+            result = (AvenTestResult){
+                .error = 3,
+                .message = "aven_fs_dir_rm failed on a -wx directory",
+            };
+        }
+
+        // Root can read any directory, so also check for the O_PATH handle
+        if (
+            dir.fd >= 0 and
+            (fcntl(dir.fd, F_GETFL) & O_PATH) == 0 and
+            result.error == 0
+        ) {
+            result = (AvenTestResult){
+                .error = 4,
+                .message = "aven_fs_dir_open did not use O_PATH",
+            };
+        }
+
+        aven_fs_dir_close(dir);
+    }
+
+    chmod(dir_path.ptr, S_IRWXU);
+    error = aven_fs_rmdir(dir_path);
+    if (error != 0 and result.error == 0) {
+        result = (AvenTestResult){
+            .error = 5,
+            .message = "aven_fs_dir cleanup failed",
+        };
+    }
+
+    return result;
+}
+#endif
+
+int test_fs(AvenArena arena) {
+    AvenTestCase tcase_data[] = {
+        {
+            .desc = "aven_fs_map empty file",
+            .fn = test_aven_fs_map,
+            .args = &(TestAvenFsMapArgs){
+                .path = "aven_test_fs_map_empty",
+                .size = 0,
+            },
+        },
+        {
+            .desc = "aven_fs_map small file",
+            .fn = test_aven_fs_map,
+            .args = &(TestAvenFsMapArgs){
+                .path = "aven_test_fs_map_small",
+                .size = 1000,
+            },
+        },
+        {
+            .desc = "aven_fs_map large file",
+            .fn = test_aven_fs_map,
+            .args = &(TestAvenFsMapArgs){
+                .path = "aven_test_fs_map_large",
+                .size = 3 * AVEN_FS_MAP_MIN_SIZE + 17,
+            },
+        },
+        {
+            .desc = "aven_fs_map missing file",
+            .fn = test_aven_fs_map_missing,
+        },
+#ifdef __linux__
+        {
+            .desc = "aven_fs_read and aven_fs_map procfs file",
+            .fn = test_aven_fs_read_proc,
+        },
+#endif
+        {
+            .desc = "aven_fs_write_atomic create and replace",
+            .fn = test_aven_fs_write_atomic,
+            .args = &(TestAvenFsWriteArgs){
+                .path = "aven_test_fs_write_atomic",
+                .contents = { "first contents\n", "replaced\n" },
+            },
+        },
+        {
+            .desc = "aven_fs_write_atomic empty file",
+            .fn = test_aven_fs_write_atomic,
+            .args = &(TestAvenFsWriteArgs){
+                .path = "aven_test_fs_write_atomic_empty",
+                .contents = { "", "" },
+            },
+        },
+#ifndef _WIN32
+        {
+            .desc = "aven_fs_write_atomic keeps the file mode",
+            .fn = test_aven_fs_write_atomic_mode,
+        },
+        {
+            .desc = "aven_fs_write_atomic from several threads",
+            .fn = test_aven_fs_write_atomic_threads,
+        },
+#endif
+        {
+            .desc = "aven_fs_read missing file",
+            .fn = test_aven_fs_read_missing,
+        },
+        {
+            .desc = "aven_fs_hash matches aven_hash",
+            .fn = test_aven_fs_hash,
+        },
+        {
+            .desc = "aven_fs_stat_cache get and invalidate",
+            .fn = test_aven_fs_stat_cache,
+        },
+        {
+            .desc = "aven_fs_batch mkdir, copy, trunc, stat, and rm",
+            .fn = test_aven_fs_batch,
+        },
+        {
+            .desc = "aven_fs_dir relative mkdir, copy, trunc, stat, and rm",
+            .fn = test_aven_fs_dir,
+        },
+#ifdef O_PATH
+        {
+            .desc = "aven_fs_dir_open on a directory without read access",
+            .fn = test_aven_fs_dir_noread,
+        },
+#endif
+    };
+    AvenTestCaseSlice tcases = {
+        .ptr = tcase_data,
+        .len = countof(tcase_data),
+    };
+
+    aven_test(tcases, __FILE__, arena);
+
+    return 0;
+}
@@ -0,0 +1,135 @@
+#include <aven.h>
+#include <aven/arena.h>
+#include <aven/hash.h>
+#include <aven/str/builder.h>
+#include <aven/test.h>
+
+typedef struct {
+    AvenHashImpl impl;
+} TestAvenHashArgs;
+
+static ByteSlice test_aven_hash_bytes(size_t len, AvenArena *arena) {
+    ByteSlice bytes = { .len = len };
+    bytes.ptr = aven_arena_alloc(arena, len, 1);
+    uint32_t x = 0x12345678;
+    for (size_t i = 0; i < len; i += 1) {
+        x = x * 1664525 + 1013904223;
+        slice_get(bytes, i) = (unsigned char)(x >> 24);
+    }
+    return bytes;
+}
+
+AvenTestResult test_aven_hash_streaming(AvenArena arena, void *args) {
+    TestAvenHashArgs *hargs = args;
+
+    if (!aven_hash_impl_supported(hargs->impl)) {
+        return (AvenTestResult){ 0 };
+    }
+
+    size_t lens[] = {
+        0, 1, 3, 4, 7, 8, 16, 17, 128, 240, 241, 1024, 1025, 2048, 5000,
+        3 * AVEN_HASH_BLOCK_LEN + AVEN_HASH_STRIPE_LEN + 1,
+    };
+    size_t steps[] = { 1, 7, 64, 1000, 1024, 5000 };
+    ByteSlice bytes = test_aven_hash_bytes(5000 + 1, &arena);
+
+    for (size_t i = 0; i < countof(lens); i += 1) {
+        ByteSlice input = { .ptr = bytes.ptr + 1, .len = lens[i] };
+        AvenHash expected = aven_hash(input, 42);
+
+        for (size_t j = 0; j < countof(steps); j += 1) {
+            AvenHashState state = aven_hash_init(42);
+            state.impl = hargs->impl;
+            for (size_t offset = 0; offset < input.len; offset += steps[j]) {
+                size_t len = min(steps[j], input.len - offset);
+                aven_hash_update(
+                    &state,
+                    (ByteSlice){ .ptr = input.ptr + offset, .len = len }
+                );
+            }
+
+            AvenHash hash = aven_hash_digest(&state);
+            if (!aven_hash_eq(hash, expected)) {
+                return (AvenTestResult){
+                    .error = 1,
+                    .message = aven_str_fmt(
+                        &arena,
+                        "mismatch for length %zu in steps of %zu",
+                        lens[i],
+                        steps[j]
+                    ).ptr,
+                };
+            }
+        }
+    }
+
+    return (AvenTestResult){ 0 };
+}
+
+AvenTestResult test_aven_hash_inputs(AvenArena arena, void *args) {
+    (void)args;
+
+    ByteSlice bytes = test_aven_hash_bytes(2 * AVEN_HASH_BLOCK_LEN, &arena);
+
+    size_t lens[] = { 0, 5, 100, 2 * AVEN_HASH_BLOCK_LEN };
+    for (size_t i = 0; i < countof(lens); i += 1) {
+        ByteSlice input = { .ptr = bytes.ptr, .len = lens[i] };
+        AvenHash hash = aven_hash(input, 0);
+
+        if (aven_hash_eq(hash, aven_hash(input, 1))) {
+            return (AvenTestResult){
+                .error = 1,
+                .message = "seed did not change the hash",
+            };
+        }
+
+        if (input.len == 0) {
+            continue;
+        }
+
+        slice_get(input, input.len / 2) ^= 1;
+        AvenHash flipped = aven_hash(input, 0);
+        slice_get(input, input.len / 2) ^= 1;
+
+        if (aven_hash_eq(hash, flipped)) {
+            return (AvenTestResult){
+                .error = 2,
+                .message = "bit flip did not change the hash",
+            };
+        }
+    }
+
+    return (AvenTestResult){ 0 };
+}
+
+int test_hash(AvenArena arena) {
+    AvenTestCase tcase_data[] = {
+        {
+            .desc = "aven_hash streaming matches one-shot (scalar)",
+            .fn = test_aven_hash_streaming,
+            .args = &(TestAvenHashArgs){ .impl = AVEN_HASH_IMPL_SCALAR },
+        },
+        {
+            .desc = "aven_hash streaming matches one-shot (SSE2)",
+            .fn = test_aven_hash_streaming,
+            .args = &(TestAvenHashArgs){ .impl = AVEN_HASH_IMPL_SSE2 },
+        },
+        {
+            .desc = "aven_hash streaming matches one-shot (AVX2)",
+            .fn = test_aven_hash_streaming,
+            .args = &(TestAvenHashArgs){ .impl = AVEN_HASH_IMPL_AVX2 },
+        },
+        {
+            .desc = "aven_hash depends on seed and input",
+            .fn = test_aven_hash_inputs,
+        },
+    };
+    AvenTestCaseSlice tcases = {
+        .ptr = tcase_data,
+        .len = countof(tcase_data),
+    };
+
+    aven_test(tcases, __FILE__, arena);
+
+    return 0;
+}
@@ -1,6 +1,7 @@
 #include <aven.h>
 #include <aven/path.h>
 #include <aven/str.h>
+#include <aven/str/builder.h>
 #include <aven/test.h>
 
 typedef struct {
@@ -52,22 +53,90 @@ AvenTestResult test_aven_path(AvenArena arena, void *args) {
     bool match = aven_str_compare(path, expected_path);
 
     if (!match) {
-        char fmt[] = "expected \"%s\", found \"%s\"";
-       
-        char *buffer = aven_arena_alloc(
-            &arena,
-            sizeof(fmt) +
-                path.len +
-                expected_path.len,
-            1
-        );
-
-        int len = sprintf(buffer, fmt, expected_path.ptr, path.ptr);
-        assert(len > 0);
-
         return (AvenTestResult){
             .error = 2,
-            .message = buffer,
+            .message = aven_str_fmt(
+                &arena,
+                "expected \"%s\", found \"%s\"",
+                expected_path.ptr,
+                path.ptr
+            ).ptr,
+        };
+    }
+
+    AvenStr parts_data[countof(pargs->parts)];
+    AvenStrSlice parts = { .ptr = parts_data, .len = pargs->nparts };
+    for (size_t i = 0; i < parts.len; i += 1) {
+        slice_get(parts, i) = aven_str_cstr(pargs->parts[i]);
+    }
+
+    AvenStr slice_path = aven_path_join_slice(parts, &arena);
+    char buffer[64];
+    AvenPathResult buffer_res = aven_path_join_buffer(
+        parts,
+        buffer,
+        countof(buffer)
+    );
+    if (
+        !aven_str_compare(slice_path, expected_path) or
+        slice_path.ptr[slice_path.len] != 0 or
+        buffer_res.error != 0 or
+        !aven_str_compare(buffer_res.payload, expected_path) or
+        buffer[buffer_res.payload.len] != 0
+    ) {
+        return (AvenTestResult){
+            .error = 3,
+            .message = "aven_path_join_slice or aven_path_join_buffer "
+                "did not match aven_path",
+        };
+    }
+
+    return (AvenTestResult){ 0 };
+}
+
+AvenTestResult test_aven_path_join_long(AvenArena arena, void *args) {
+    (void)args;
+
+    // More components than aven_path used to accept
+    AvenStr parts_data[40];
+    AvenStrSlice parts = { .ptr = parts_data, .len = countof(parts_data) };
+    for (size_t i = 0; i < parts.len; i += 1) {
+        slice_get(parts, i) = aven_str("ab");
+    }
+
+    AvenStr path = aven_path_join_slice(parts, &arena);
+    if (path.len != 3 * parts.len - 1) {
+        return (AvenTestResult){
+            .error = 1,
+            .message = "aven_path_join_slice wrong length",
+        };
+    }
+    for (size_t i = 0; i < path.len; i += 1) {
+        char expected = (i % 3 == 2) ? AVEN_PATH_SEP : (i % 3 == 0 ? 'a' : 'b');
+        if (slice_get(path, i) != expected) {
+            return (AvenTestResult){
+                .error = 2,
+                .message = "aven_path_join_slice wrong contents",
+            };
+        }
+    }
+
+    // The buffer must also hold the NUL terminator
+    char buffer[128];
+    AvenPathResult exact_res = aven_path_join_buffer(
+        parts,
+        buffer,
+        path.len + 1
+    );
+    AvenPathResult short_res = aven_path_join_buffer(parts, buffer, path.len);
+    if (
+        exact_res.error != 0 or
+        !aven_str_compare(exact_res.payload, path) or
+        short_res.error != AVEN_PATH_JOIN_ERROR_SPACE
+    ) {
+        return (AvenTestResult){
+            .error = 3,
+            .message = "aven_path_join_buffer wrong size check",
         };
     }
 
@@ -87,22 +156,69 @@ AvenTestResult test_aven_path_rel_dir(AvenArena arena, void *args) {
     bool match = aven_str_compare(path, expected_path);
 
     if (!match) {
-        char fmt[] = "expected \"%s\", found \"%s\"";
-       
-        char *buffer = aven_arena_alloc(
-            &arena,
-            sizeof(fmt) +
-                path.len +
-                expected_path.len,
-            1
-        );
-
-        int len = sprintf(buffer, fmt, expected_path.ptr, path.ptr);
-        assert(len > 0);
+        return (AvenTestResult){
+            .error = 2,
+            .message = aven_str_fmt(
+                &arena,
+                "expected \"%s\", found \"%s\"",
+                expected_path.ptr,
+                path.ptr
+            ).ptr,
+        };
+    }
+
+    return (AvenTestResult){ 0 };
+}
 
+typedef struct {
+    char *expected;
+    char *path;
+} TestAvenPathNormalizeArgs;
+
+// Test paths use '/', which is swapped for AVEN_PATH_SEP
+static AvenStr test_aven_path_native(char *cstr, AvenArena *arena) {
+    AvenStr path = aven_str_copy(aven_str_cstr(cstr), arena);
+    for (size_t i = 0; i < path.len; i += 1) {
+        if (slice_get(path, i) == '/') {
+            slice_get(path, i) = AVEN_PATH_SEP;
+        }
+    }
+    return path;
+}
+
+AvenTestResult test_aven_path_normalize(AvenArena arena, void *args) {
+    TestAvenPathNormalizeArgs *pargs = args;
+
+    AvenStr path = test_aven_path_native(pargs->path, &arena);
+    AvenStr expected_path = test_aven_path_native(pargs->expected, &arena);
+
+    char *buffer = aven_arena_alloc(&arena, path.len + 1, 1);
+    AvenStr normalized = aven_path_normalize(path, buffer);
+    if (
+        !aven_str_compare(normalized, expected_path) or
+        normalized.ptr[normalized.len] != 0
+    ) {
+        return (AvenTestResult){
+            .error = 1,
+            .message = aven_str_fmt(
+                &arena,
+                "expected \"%s\", found \"%s\"",
+                expected_path.ptr,
+                normalized.ptr
+            ).ptr,
+        };
+    }
+
+    AvenStr in_place = aven_path_normalize(path, path.ptr);
+    if (!aven_str_compare(in_place, expected_path)) {
         return (AvenTestResult){
             .error = 2,
-            .message = buffer,
+            .message = aven_str_fmt(
+                &arena,
+                "in place expected \"%s\", found \"%s\"",
+                expected_path.ptr,
+                in_place.ptr
+            ).ptr,
         };
     }
 
@@ -118,29 +234,57 @@ typedef struct {
 AvenTestResult test_aven_path_rel_diff(AvenArena arena, void *args) {
     TestAvenPathDiffArgs *pargs = args;
 
+    // Only the result should be allocated
+    unsigned char *base = arena.base;
     AvenStr path = aven_path_rel_diff(
         aven_str_cstr(pargs->path1),
         aven_str_cstr(pargs->path2),
         &arena
     );
+    if ((size_t)(arena.base - base) != path.len + 1) {
+        return (AvenTestResult){
+            .error = 1,
+            .message = "aven_path_rel_diff allocated more than its result",
+        };
+    }
+
     AvenStr expected_path = aven_str_cstr(pargs->expected);
     bool match = aven_str_compare(path, expected_path);
 
     if (!match) {
-        char fmt[] = "expected \"%s\", found \"%s\"";
-       
-        char *buffer = malloc(
-            sizeof(fmt) +
-            path.len +
-            expected_path.len
-        );
+        return (AvenTestResult){
+            .error = 3,
+            .message = aven_str_fmt(
+                &arena,
+                "expected \"%s\", found \"%s\"",
+                expected_path.ptr,
+                path.ptr
+            ).ptr,
+        };
+    }
 
-        int len = sprintf(buffer, fmt, expected_path.ptr, path.ptr);
-        assert(len > 0);
+    return (AvenTestResult){ 0 };
+}
 
+AvenTestResult test_aven_path_rel_intersect(AvenArena arena, void *args) {
+    TestAvenPathDiffArgs *pargs = args;
+
+    AvenStr path = aven_path_rel_intersect(
+        test_aven_path_native(pargs->path1, &arena),
+        test_aven_path_native(pargs->path2, &arena),
+        &arena
+    );
+    AvenStr expected_path = test_aven_path_native(pargs->expected, &arena);
+
+    if (!aven_str_compare(path, expected_path)) {
         return (AvenTestResult){
-            .error = 3,
-            .message = buffer,
+            .error = 1,
+            .message = aven_str_fmt(
+                &arena,
+                "expected \"%s\", found \"%s\"",
+                expected_path.ptr,
+                path.ptr
+            ).ptr,
         };
     }
 
@@ -206,6 +350,10 @@ int test_path(AvenArena arena) {
                 .parts = { "purely", "functional", "data", "structures" },
             },
         },
+        {
+            .desc = "aven_path_join_slice many components",
+            .fn = test_aven_path_join_long,
+        },
         {
             .desc = "aven_path_rel_dir 1 level relative path",
             .fn = test_aven_path_rel_dir,
@@ -227,6 +375,132 @@ int test_path(AvenArena arena) {
 #endif
             },
         },
+        {
+            .desc = "aven_path_normalize collapses '.', '..' and separators",
+            .fn = test_aven_path_normalize,
+            .args = &(TestAvenPathNormalizeArgs){
+                .expected = "b/c",
+                .path = "./a/../b//c",
+            },
+        },
+        {
+            .desc = "aven_path_normalize empty path",
+            .fn = test_aven_path_normalize,
+            .args = &(TestAvenPathNormalizeArgs){
+                .expected = "",
+                .path = "",
+            },
+        },
+        {
+            .desc = "aven_path_normalize '.'",
+            .fn = test_aven_path_normalize,
+            .args = &(TestAvenPathNormalizeArgs){
+                .expected = ".",
+                .path = ".",
+            },
+        },
+        {
+            .desc = "aven_path_normalize path that cancels out",
+            .fn = test_aven_path_normalize,
+            .args = &(TestAvenPathNormalizeArgs){
+                .expected = ".",
+                .path = "a/b/../..",
+            },
+        },
+        {
+            .desc = "aven_path_normalize keeps leading '..'",
+            .fn = test_aven_path_normalize,
+            .args = &(TestAvenPathNormalizeArgs){
+                .expected = "../../a/b",
+                .path = "../../a/./b/",
+            },
+        },
+        {
+            .desc = "aven_path_normalize '..' past the start",
+            .fn = test_aven_path_normalize,
+            .args = &(TestAvenPathNormalizeArgs){
+                .expected = "..",
+                .path = "a/../../b/..",
+            },
+        },
+        {
+            .desc = "aven_path_normalize '..' after leading '..'",
+            .fn = test_aven_path_normalize,
+            .args = &(TestAvenPathNormalizeArgs){
+                .expected = "..",
+                .path = "../a/..",
+            },
+        },
+        {
+            .desc = "aven_path_normalize absolute path",
+            .fn = test_aven_path_normalize,
+            .args = &(TestAvenPathNormalizeArgs){
+                .expected = "/a/b",
+                .path = "//../a//b/.",
+            },
+        },
+        {
+            .desc = "aven_path_normalize root",
+            .fn = test_aven_path_normalize,
+            .args = &(TestAvenPathNormalizeArgs){
+                .expected = "/",
+                .path = "/..",
+            },
+        },
+        {
+            .desc = "aven_path_normalize dotted names",
+            .fn = test_aven_path_normalize,
+            .args = &(TestAvenPathNormalizeArgs){
+                .expected = "a/..b/.c/...",
+                .path = "a/..b/.c/...",
+            },
+        },
+#ifdef _WIN32
+        {
+            .desc = "aven_path_normalize drive root",
+            .fn = test_aven_path_normalize,
+            .args = &(TestAvenPathNormalizeArgs){
+                .expected = "C:/b",
+                .path = "C:/../a/../b",
+            },
+        },
+#endif
+        {
+            .desc = "aven_path_rel_intersect shared prefix",
+            .fn = test_aven_path_rel_intersect,
+            .args = &(TestAvenPathDiffArgs){
+                .expected = "a/b",
+                .path1 = "a/b/c",
+                .path2 = "a//b/d/",
+            },
+        },
+        {
+            .desc = "aven_path_rel_intersect same path",
+            .fn = test_aven_path_rel_intersect,
+            .args = &(TestAvenPathDiffArgs){
+                .expected = "a/b",
+                .path1 = "a/b",
+                .path2 = "a/b",
+            },
+        },
+        {
+            .desc = "aven_path_rel_intersect nothing shared",
+            .fn = test_aven_path_rel_intersect,
+            .args = &(TestAvenPathDiffArgs){
+                .expected = "",
+                .path1 = "a/b",
+                .path2 = "a2/b",
+            },
+        },
+        {
+            .desc = "aven_path_rel_intersect partial component",
+            .fn = test_aven_path_rel_intersect,
+            .args = &(TestAvenPathDiffArgs){
+                .expected = "",
+                .path1 = "ab/c",
+                .path2 = "a/c",
+            },
+        },
         {
             .desc = "aven_path_rel_diff same dir relative path",
             .fn = test_aven_path_rel_diff,
@@ -314,6 +588,21 @@ int test_path(AvenArena arena) {
                 .expected = "./b",
                 .path1 = "a/b",
                 .path2 = "a",
+#endif
+            },
+        },
+        {
+            .desc = "aven_path_rel_diff repeated separators",
+            .fn = test_aven_path_rel_diff,
+            .args = &(TestAvenPathDiffArgs){
+#ifdef _WIN32
+                .expected = ".\\..\\..\\c\\d",
+                .path1 = ".\\a\\\\c\\d\\",
+                .path2 = "a\\b\\\\e",
+#else
+                .expected = "./../../c/d",
+                .path1 = "./a//c/d/",
+                .path2 = "a/b//e",
 #endif
             },
         },
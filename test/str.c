@@ -0,0 +1,902 @@
+#include <aven.h>
+#include <aven/arena.h>
+#include <aven/str.h>
+#include <aven/str/builder.h>
+#include <aven/str/intern.h>
+#include <aven/str/map.h>
+#include <aven/str/rope.h>
+#include <aven/test.h>
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+// Lengths around every vector and word width the kernels use
+static size_t test_aven_str_lens[] = {
+    0, 1, 7, 8, 9, 15, 16, 17, 31, 32, 33, 63, 64, 65, 100, 255, 1000,
+    32 * 255 + 40,
+};
+
+static AvenStr test_aven_str_random(size_t len, AvenArena *arena) {
+    // Pad both ends so slices at any offset stay inside the allocation
+    AvenStr str = { .len = len + 64 };
+    str.ptr = aven_arena_alloc(arena, str.len + 1, 32);
+    uint32_t x = (uint32_t)len * 2654435761U + 1;
+    for (size_t i = 0; i < str.len; i += 1) {
+        x = x * 1664525 + 1013904223;
+        // Mostly separators and letters from a small alphabet
+        str.ptr[i] = "ab,c"[x >> 30];
+    }
+    str.ptr[str.len] = 0;
+    return str;
+}
+
+AvenTestResult test_aven_str_primitives(AvenArena arena, void *args) {
+    (void)args;
+
+    for (size_t i = 0; i < countof(test_aven_str_lens); i += 1) {
+        size_t len = test_aven_str_lens[i];
+        AvenStr buffer = test_aven_str_random(len, &arena);
+
+        for (size_t offset = 0; offset < 33; offset += 1) {
+            AvenStr str = { .ptr = buffer.ptr + offset, .len = len };
+
+            size_t count = 0;
+            size_t first = len;
+            for (size_t j = len; j > 0; j -= 1) {
+                if (str.ptr[j - 1] == ',') {
+                    count += 1;
+                    first = j - 1;
+                }
+            }
+
+            if (aven_str_count_char(str, ',') != count) {
+                return (AvenTestResult){
+                    .error = 1,
+                    .message = "aven_str_count_char miscounted",
+                };
+            }
+
+            AvenStrOptionalIndex index = aven_str_find_char(str, ',');
+            if (
+                index.valid != (first < len) or
+                (index.valid and index.value != first)
+            ) {
+                return (AvenTestResult){
+                    .error = 2,
+                    .message = "aven_str_find_char wrong index",
+                };
+            }
+
+            char saved = str.ptr[len];
+            str.ptr[len] = 0;
+            size_t cstr_len = aven_str_cstr_len(str.ptr);
+            str.ptr[len] = saved;
+            if (cstr_len != len) {
+                return (AvenTestResult){
+                    .error = 3,
+                    .message = "aven_str_cstr_len wrong length",
+                };
+            }
+
+            AvenStr copy = aven_str_copy(str, &arena);
+            if (!aven_str_compare(str, copy)) {
+                return (AvenTestResult){
+                    .error = 4,
+                    .message = "aven_str_compare equal strings differ",
+                };
+            }
+            if (len > 0) {
+                copy.ptr[len - 1 - offset % len] ^= 1;
+                if (aven_str_compare(str, copy)) {
+                    return (AvenTestResult){
+                        .error = 5,
+                        .message = "aven_str_compare unequal strings match",
+                    };
+                }
+            }
+        }
+    }
+
+    return (AvenTestResult){ 0 };
+}
+
+AvenTestResult test_aven_str_split(AvenArena arena, void *args) {
+    (void)args;
+
+    char *expected[] = { "a", "bc", "def" };
+    AvenStrSlice split = aven_str_split(aven_str(",,a,bc,,def,"), ',', &arena);
+    if (split.len != countof(expected)) {
+        return (AvenTestResult){
+            .error = 1,
+            .message = "aven_str_split wrong token count",
+        };
+    }
+    for (size_t i = 0; i < split.len; i += 1) {
+        AvenStr token = slice_get(split, i);
+        if (
+            !aven_str_compare(token, aven_str_cstr(expected[i])) or
+            token.ptr[token.len] != 0
+        ) {
+            return (AvenTestResult){
+                .error = 2,
+                .message = "aven_str_split wrong token",
+            };
+        }
+    }
+
+    if (aven_str_split(aven_str(",,,"), ',', &arena).len != 0) {
+        return (AvenTestResult){
+            .error = 3,
+            .message = "aven_str_split expected no tokens",
+        };
+    }
+
+    AvenStr str = aven_str(",,a,bc,,def,");
+    AvenStrSlice views = aven_str_split_view(str, ',', &arena);
+    if (
+        views.len != countof(expected) or
+        slice_get(views, 0).ptr != str.ptr + 2 or
+        slice_get(views, 2).ptr != str.ptr + 8 or
+        !aven_str_compare(slice_get(views, 2), aven_str("def"))
+    ) {
+        return (AvenTestResult){
+            .error = 4,
+            .message = "aven_str_split_view tokens are not views",
+        };
+    }
+
+    return (AvenTestResult){ 0 };
+}
+
+AvenTestResult test_aven_str_tokenizer(AvenArena arena, void *args) {
+    (void)args;
+
+    // Single character tokens match aven_str_split_view
+    for (size_t i = 0; i < countof(test_aven_str_lens); i += 1) {
+        AvenStr str = test_aven_str_random(test_aven_str_lens[i], &arena);
+        AvenStrSlice views = aven_str_split_view(str, ',', &arena);
+
+        AvenStrTokenizer tokenizer = aven_str_tokenizer(str, ',');
+        for (size_t j = 0; j < views.len; j += 1) {
+            AvenStrOptional token = aven_str_tokenizer_next(&tokenizer);
+            if (
+                !token.valid or
+                token.value.ptr != slice_get(views, j).ptr or
+                token.value.len != slice_get(views, j).len
+            ) {
+                return (AvenTestResult){
+                    .error = 1,
+                    .message = "tokenizer differs from aven_str_split_view",
+                };
+            }
+        }
+        if (aven_str_tokenizer_next(&tokenizer).valid) {
+            return (AvenTestResult){
+                .error = 2,
+                .message = "tokenizer produced extra tokens",
+            };
+        }
+    }
+
+    char *expected[] = { "obj.o:", "a.c", "b.h", "c.h" };
+    AvenStrTokenizer tokenizer = aven_str_tokenizer_space(
+        aven_str("  obj.o: a.c \t\n b.h\r\nc.h\n")
+    );
+    for (size_t i = 0; i < countof(expected); i += 1) {
+        AvenStrOptional token = aven_str_tokenizer_next(&tokenizer);
+        if (
+            !token.valid or
+            !aven_str_compare(token.value, aven_str_cstr(expected[i]))
+        ) {
+            return (AvenTestResult){
+                .error = 3,
+                .message = "whitespace tokenizer wrong token",
+            };
+        }
+    }
+    if (aven_str_tokenizer_next(&tokenizer).valid) {
+        return (AvenTestResult){
+            .error = 4,
+            .message = "whitespace tokenizer produced extra tokens",
+        };
+    }
+
+    tokenizer = aven_str_tokenizer_set(aven_str("a=1;b=2"), aven_str("=;"));
+    AvenStrOptional last = { 0 };
+    for (size_t i = 0; i < 4; i += 1) {
+        last = aven_str_tokenizer_next(&tokenizer);
+    }
+    if (!last.valid or !aven_str_compare(last.value, aven_str("2"))) {
+        return (AvenTestResult){
+            .error = 5,
+            .message = "character set tokenizer wrong token",
+        };
+    }
+
+    return (AvenTestResult){ 0 };
+}
+
+AvenTestResult test_aven_str_intern(AvenArena arena, void *args) {
+    (void)args;
+
+    AvenStrInternTable table = aven_str_intern_table_init(0, &arena);
+
+    // Enough distinct strings to grow the table several times
+    char buffer[32];
+    AvenStrIntern first[200];
+    for (size_t i = 0; i < countof(first); i += 1) {
+        size_t len = 0;
+        for (size_t n = i + 1; n > 0; n /= 10) {
+            buffer[len] = (char)('0' + n % 10);
+            len += 1;
+        }
+        AvenStr str = { .ptr = buffer, .len = len };
+        first[i] = aven_str_intern(&table, str, &arena);
+        if (first[i].str.ptr == buffer or first[i].str.ptr[len] != 0) {
+            return (AvenTestResult){
+                .error = 1,
+                .message = "interned string not copied",
+            };
+        }
+    }
+
+    // Interning again returns the canonical copy without allocating
+    unsigned char *base = arena.base;
+    for (size_t i = 0; i < countof(first); i += 1) {
+        AvenStr copy = aven_str_copy(first[i].str, &arena);
+        AvenStrIntern again = aven_str_intern(&table, copy, &arena);
+        if (!aven_str_intern_eq(again, first[i])) {
+            return (AvenTestResult){
+                .error = 2,
+                .message = "duplicate string not canonicalized",
+            };
+        }
+    }
+    if (
+        table.len != countof(first) or
+        arena.base - base > (ptrdiff_t)(countof(first) * 8)
+    ) {
+        return (AvenTestResult){
+            .error = 3,
+            .message = "duplicate strings were stored",
+        };
+    }
+
+    AvenStrInternOptional missing = aven_str_intern_find(
+        &table,
+        aven_str("missing")
+    );
+    AvenStrInternOptional found = aven_str_intern_find(&table, aven_str("1"));
+    if (
+        missing.valid or
+        !found.valid or
+        !aven_str_intern_eq(found.value, first[0])
+    ) {
+        return (AvenTestResult){
+            .error = 4,
+            .message = "aven_str_intern_find wrong result",
+        };
+    }
+
+    return (AvenTestResult){ 0 };
+}
+
+static AvenStr test_aven_str_map_key(size_t i, AvenArena *arena) {
+    char buffer[32];
+    size_t len = 0;
+    for (size_t n = i; n > 0 or len == 0; n /= 10) {
+        buffer[len] = (char)('a' + n % 10);
+        len += 1;
+    }
+    return aven_str_copy((AvenStr){ .ptr = buffer, .len = len }, arena);
+}
+
+AvenTestResult test_aven_str_map(AvenArena arena, void *args) {
+    (void)args;
+
+    size_t nkeys = 5000;
+    AvenStr *keys = aven_arena_create_array(AvenStr, &arena, nkeys);
+    for (size_t i = 0; i < nkeys; i += 1) {
+        keys[i] = test_aven_str_map_key(i, &arena);
+    }
+
+    AvenStrMap map = aven_str_map_init_type(size_t, 0, &arena);
+    for (size_t i = 0; i < nkeys; i += 1) {
+        size_t *value = aven_str_map_insert(&map, keys[i], &arena);
+        if (*value != 0) {
+            return (AvenTestResult){
+                .error = 1,
+                .message = "new value not zeroed",
+            };
+        }
+        *value = i + 1;
+    }
+
+    // Remove every other key, then reinsert half of those
+    for (size_t i = 0; i < nkeys; i += 2) {
+        if (!aven_str_map_remove(&map, keys[i])) {
+            return (AvenTestResult){
+                .error = 2,
+                .message = "aven_str_map_remove missed a key",
+            };
+        }
+    }
+    for (size_t i = 0; i < nkeys; i += 4) {
+        size_t *value = aven_str_map_insert(&map, keys[i], &arena);
+        *value = i + 1;
+    }
+
+    for (size_t i = 0; i < nkeys; i += 1) {
+        size_t *value = aven_str_map_get(&map, keys[i]);
+        bool present = (i % 2 == 1) or (i % 4 == 0);
+        if ((value != NULL) != present or (present and *value != i + 1)) {
+            return (AvenTestResult){
+                .error = 3,
+                .message = "aven_str_map_get wrong result",
+            };
+        }
+    }
+
+    size_t count = 0;
+    size_t index = 0;
+    for (
+        AvenStrMapOptionalEntry entry = aven_str_map_next(&map, &index);
+        entry.valid;
+        entry = aven_str_map_next(&map, &index)
+    ) {
+        count += 1;
+    }
+    if (count != map.len or map.len != nkeys / 2 + nkeys / 4) {
+        return (AvenTestResult){
+            .error = 4,
+            .message = "iteration visited the wrong number of entries",
+        };
+    }
+
+    aven_str_map_clear(&map);
+    if (map.len != 0 or aven_str_map_get(&map, keys[1]) != NULL) {
+        return (AvenTestResult){
+            .error = 5,
+            .message = "aven_str_map_clear left entries",
+        };
+    }
+
+    return (AvenTestResult){ 0 };
+}
+
+AvenTestResult test_aven_str_builder(AvenArena arena, void *args) {
+    (void)args;
+
+    // Growing while the builder is the last allocation never moves it
+    AvenStrBuilder builder = { 0 };
+    aven_str_builder_push_char(&builder, '[', &arena);
+    char *start = builder.ptr;
+    for (size_t i = 0; i < 1000; i += 1) {
+        aven_str_builder_push_uint(&builder, i, &arena);
+        aven_str_builder_push(&builder, aven_str(", "), &arena);
+    }
+    aven_str_builder_push_int(&builder, -9223372036854775807LL - 1, &arena);
+    aven_str_builder_push_char(&builder, ' ', &arena);
+    aven_str_builder_push_hex(&builder, 0xdeadbeefULL, &arena);
+    aven_str_builder_push_char(&builder, ' ', &arena);
+    aven_str_builder_push_float(&builder, -2.5, 3, &arena);
+    AvenStr str = aven_str_builder_finish(&builder, &arena);
+
+    if (
+        str.ptr != start or
+        (unsigned char *)str.ptr + str.len + 1 != arena.base
+    ) {
+        return (AvenTestResult){
+            .error = 1,
+            .message = "builder did not grow and shrink in place",
+        };
+    }
+
+    AvenStr tail = aven_str("998, 999, -9223372036854775808 deadbeef -2.500");
+    AvenStr end = { .ptr = str.ptr + str.len - tail.len, .len = tail.len };
+    if (
+        str.ptr[str.len] != 0 or
+        !aven_str_compare(end, tail) or
+        !aven_str_compare(
+            (AvenStr){ .ptr = str.ptr, .len = 8 },
+            aven_str("[0, 1, 2")
+        )
+    ) {
+        return (AvenTestResult){
+            .error = 2,
+            .message = "builder contents wrong",
+        };
+    }
+
+    return (AvenTestResult){ 0 };
+}
+
+#define TEST_AVEN_STR_FMT(...) do { \
+        char expected[256]; \
+        int len = snprintf(expected, sizeof(expected), __VA_ARGS__); \
+        AvenStr found = aven_str_fmt(&arena, __VA_ARGS__); \
+        if ( \
+            !aven_str_compare( \
+                found, \
+                (AvenStr){ .ptr = expected, .len = (size_t)len } \
+            ) \
+        ) { \
+            return (AvenTestResult){ \
+                .error = __LINE__, \
+                .message = aven_str_fmt( \
+                    &arena, \
+                    "expected \"%s\", found \"%s\"", \
+                    expected, \
+                    found.ptr \
+                ).ptr, \
+            }; \
+        } \
+    } while (0)
+
+AvenTestResult test_aven_str_fmt(AvenArena arena, void *args) {
+    (void)args;
+
+    AvenStr str = aven_str("abcdef");
+    TEST_AVEN_STR_FMT("plain text");
+    TEST_AVEN_STR_FMT("%d %i %u %%", 0, -42, 4000000000U);
+    TEST_AVEN_STR_FMT("%ld %llu %zu", -1L, 18446744073709551615ULL, str.len);
+    TEST_AVEN_STR_FMT("%lld %jd", -9223372036854775807LL - 1, (intmax_t)12);
+    TEST_AVEN_STR_FMT("%hhd %hu %td", 300, 70000, (ptrdiff_t)-3);
+    TEST_AVEN_STR_FMT("%x %X %08x %p", 0xabcU, 0xabcU, 0xbeefU, (void *)&str);
+    TEST_AVEN_STR_FMT("[%5d] [%-5d] [%05d] [%+d] [% d]", 42, 42, -42, 7, 7);
+    TEST_AVEN_STR_FMT("[%.3d] [%8.3d] [%.0d] [%*d]", 5, -5, 0, -4, 9);
+    TEST_AVEN_STR_FMT("[%s] [%10s] [%-10s] [%.2s]", "a", "bc", "de", "fgh");
+    TEST_AVEN_STR_FMT("[%.*s] [%c] [%3c]", (int)str.len - 2, str.ptr, 'x', 'y');
+    TEST_AVEN_STR_FMT("%f %f %f", 0.0, -0.0, 1.0);
+    TEST_AVEN_STR_FMT("%.2f %.0f %.3f", 3.14159, 2.75, -0.0005);
+    TEST_AVEN_STR_FMT("%10.3f|%-10.1f|%010.2f", 1.5, -1.26, -7.126);
+    TEST_AVEN_STR_FMT("%f %.1f", 1e20, 123456789012.0);
+    TEST_AVEN_STR_FMT("%.10f %f", 123456789012.345, 28793187507692.3);
+    TEST_AVEN_STR_FMT("%.3f %.12f", 9007199254740991.0, 1234567.999999999999);
+    TEST_AVEN_STR_FMT("%e %.2e %.0e", 12345.678, 0.000123, 5e-300);
+    double inf = (double)INFINITY;
+    double nan = (double)NAN;
+    TEST_AVEN_STR_FMT("%f %e %+f %5f", inf, -inf, nan, nan);
+
+    return (AvenTestResult){ 0 };
+}
+
+// An independent reference: decode by bit pattern, then reject overlong
+// encodings, surrogates, and values past U+10FFFF by value
+static bool test_aven_str_utf8_reference(AvenStr str) {
+    const unsigned char *ptr = (const unsigned char *)str.ptr;
+    size_t i = 0;
+    while (i < str.len) {
+        unsigned char lead = ptr[i];
+        size_t trail;
+        uint32_t value;
+        uint32_t min_value;
+        if (lead < 0x80) {
+            i += 1;
+            continue;
+        } else if ((lead & 0xe0) == 0xc0) {
+            trail = 1;
+            value = lead & 0x1f;
+            min_value = 0x80;
+        } else if ((lead & 0xf0) == 0xe0) {
+            trail = 2;
+            value = lead & 0x0f;
+            min_value = 0x800;
+        } else if ((lead & 0xf8) == 0xf0) {
+            trail = 3;
+            value = lead & 0x07;
+            min_value = 0x10000;
+        } else {
+            return false;
+        }
+        if (str.len - i <= trail) {
+            return false;
+        }
+        for (size_t j = 1; j <= trail; j += 1) {
+            if ((ptr[i + j] & 0xc0) != 0x80) {
+                return false;
+            }
+            value = (value << 6) | (ptr[i + j] & 0x3f);
+        }
+        if (
+            value < min_value or
+            value > 0x10ffff or
+            (value >= 0xd800 and value <= 0xdfff)
+        ) {
+            return false;
+        }
+        i += trail + 1;
+    }
+    return true;
+}
+
+AvenTestResult test_aven_str_utf8_valid(AvenArena arena, void *args) {
+    (void)args;
+
+    AvenStr cases[] = {
+        aven_str("\xc3\xa9"),
+        aven_str("\xe2\x82\xac"),
+        aven_str("\xf0\x9f\x98\x80"),
+        aven_str("\xf4\x8f\xbf\xbf"),
+        aven_str("\xed\x9f\xbf"),
+        aven_str("\xc0\xaf"),
+        aven_str("\xc1\xbf"),
+        aven_str("\xe0\x9f\xbf"),
+        aven_str("\xed\xa0\x80"),
+        aven_str("\xf0\x8f\xbf\xbf"),
+        aven_str("\xf4\x90\x80\x80"),
+        aven_str("\xf5\x80\x80\x80"),
+        aven_str("\xff"),
+        aven_str("\x80"),
+        aven_str("\xc3"),
+        aven_str("\xe2\x82"),
+        aven_str("\xf0\x9f\x98"),
+        aven_str("\xc3\xa9\xa9"),
+        aven_str("\xe2\x82\xac\x80"),
+    };
+
+    // Place each case at every offset across a vector boundary, with the
+    // rest of the string ASCII or valid multi-byte text
+    char *fills[] = { "a", "\xc3\xa9" };
+    for (size_t c = 0; c < countof(cases); c += 1) {
+        for (size_t f = 0; f < countof(fills); f += 1) {
+            AvenStr fill = aven_str_cstr(fills[f]);
+            for (size_t offset = 0; offset < 70; offset += 1) {
+                AvenArena temp_arena = arena;
+                AvenStr str = { .len = offset * fill.len + cases[c].len };
+                str.len += 40 * fill.len;
+                str.ptr = aven_arena_alloc(&temp_arena, str.len, 1);
+
+                char *dst = str.ptr;
+                for (size_t i = 0; i < offset; i += 1) {
+                    memcpy(dst, fill.ptr, fill.len);
+                    dst += fill.len;
+                }
+                memcpy(dst, cases[c].ptr, cases[c].len);
+                dst += cases[c].len;
+                for (size_t i = 0; i < 40; i += 1) {
+                    memcpy(dst, fill.ptr, fill.len);
+                    dst += fill.len;
+                }
+
+                // Also check with the case cut off at the end
+                AvenStr prefix = {
+                    .ptr = str.ptr,
+                    .len = offset * fill.len + cases[c].len,
+                };
+                if (
+                    aven_str_utf8_valid(str) !=
+                        test_aven_str_utf8_reference(str) or
+                    aven_str_utf8_valid(prefix) !=
+                        test_aven_str_utf8_reference(prefix)
+                ) {
+                    return (AvenTestResult){
+                        .error = 1,
+                        .message = "aven_str_utf8_valid wrong for a case",
+                    };
+                }
+            }
+        }
+    }
+
+    // Random strings biased toward lead and continuation bytes
+    unsigned char alphabet[] = {
+        'a', 0x80, 0x8f, 0x90, 0x9f, 0xa0, 0xbf, 0xc0, 0xc2, 0xdf, 0xe0,
+        0xe1, 0xed, 0xef, 0xf0, 0xf1, 0xf4, 0xf5, 0xff,
+    };
+    uint32_t x = 12345;
+    for (size_t n = 0; n < 20000; n += 1) {
+        char buffer[100];
+        x = x * 1664525U + 1013904223U;
+        AvenStr str = { .ptr = buffer, .len = (x >> 8) % sizeof(buffer) };
+        for (size_t i = 0; i < str.len; i += 1) {
+            x = x * 1664525U + 1013904223U;
+            buffer[i] = (char)alphabet[(x >> 16) % countof(alphabet)];
+        }
+        if (aven_str_utf8_valid(str) != test_aven_str_utf8_reference(str)) {
+            return (AvenTestResult){
+                .error = 2,
+                .message = "aven_str_utf8_valid wrong for random bytes",
+            };
+        }
+    }
+
+    return (AvenTestResult){ 0 };
+}
+
+AvenTestResult test_aven_str_utf8_next(AvenArena arena, void *args) {
+    (void)arena;
+    (void)args;
+
+    AvenStr str = aven_str(
+        "a\xc3\xa9\xe2\x82\xac\xf0\x9f\x98\x80\xe2\x82x\xc0\xaf\xed\xa0\x80"
+    );
+    uint32_t expected[] = {
+        'a', 0xe9, 0x20ac, 0x1f600, 0xfffd, 'x', 0xfffd, 0xfffd, 0xfffd,
+        0xfffd, 0xfffd,
+    };
+
+    size_t count = 0;
+    size_t index = 0;
+    for (
+        AvenStrOptionalCodepoint codepoint = aven_str_utf8_next(str, &index);
+        codepoint.valid;
+        codepoint = aven_str_utf8_next(str, &index)
+    ) {
+        if (count == countof(expected) or codepoint.value != expected[count]) {
+            return (AvenTestResult){
+                .error = 1,
+                .message = "aven_str_utf8_next wrong code point",
+            };
+        }
+        count += 1;
+    }
+    if (count != countof(expected)) {
+        return (AvenTestResult){
+            .error = 2,
+            .message = "aven_str_utf8_next ended early",
+        };
+    }
+
+    AvenStr wide = aven_str("\xe6\x97\xa5\xe6\x9c\xac\xe8\xaa\x9e");
+    AvenStr accent = aven_str("e\xcc\x81x");
+    if (
+        aven_str_utf8_truncate(wide, 5).len != 6 or
+        aven_str_utf8_truncate(wide, 1).len != 0 or
+        aven_str_utf8_truncate(wide, 6).len != wide.len or
+        aven_str_utf8_truncate(accent, 1).len != 3 or
+        aven_str_utf8_truncate(aven_str("abc"), 2).len != 2
+    ) {
+        return (AvenTestResult){
+            .error = 3,
+            .message = "aven_str_utf8_truncate wrong length",
+        };
+    }
+
+    return (AvenTestResult){ 0 };
+}
+
+static AvenStrOptionalIndex test_aven_str_find_naive(
+    AvenStr str,
+    AvenStr needle,
+    bool last
+) {
+    AvenStrOptionalIndex found = { 0 };
+    for (size_t i = 0; i + needle.len <= str.len; i += 1) {
+        if (memcmp(str.ptr + i, needle.ptr, needle.len) == 0) {
+            found = (AvenStrOptionalIndex){ .value = i, .valid = true };
+            if (!last) {
+                break;
+            }
+        }
+    }
+    return found;
+}
+
+static bool test_aven_str_find_check(AvenStr str, AvenStr needle) {
+    AvenStrOptionalIndex first = aven_str_find(str, needle);
+    AvenStrOptionalIndex last = aven_str_find_last(str, needle);
+    AvenStrOptionalIndex naive_first = test_aven_str_find_naive(
+        str,
+        needle,
+        false
+    );
+    AvenStrOptionalIndex naive_last = test_aven_str_find_naive(
+        str,
+        needle,
+        true
+    );
+    return first.valid == naive_first.valid and
+        last.valid == naive_last.valid and
+        (!first.valid or first.value == naive_first.value) and
+        (!last.valid or last.value == naive_last.value);
+}
+
+AvenTestResult test_aven_str_find(AvenArena arena, void *args) {
+    (void)args;
+
+    // Small alphabets make partial and overlapping matches common
+    uint32_t x = 777;
+    for (size_t n = 0; n < 20000; n += 1) {
+        char str_buffer[200];
+        char needle_buffer[12];
+        x = x * 1664525U + 1013904223U;
+        uint32_t alphabet = 2 + (x >> 28) % 3;
+        AvenStr str = { .ptr = str_buffer, .len = (x >> 8) % 200 };
+        x = x * 1664525U + 1013904223U;
+        AvenStr needle = { .ptr = needle_buffer, .len = (x >> 8) % 12 };
+        for (size_t i = 0; i < str.len; i += 1) {
+            x = x * 1664525U + 1013904223U;
+            str_buffer[i] = (char)('a' + (x >> 16) % alphabet);
+        }
+        for (size_t i = 0; i < needle.len; i += 1) {
+            x = x * 1664525U + 1013904223U;
+            needle_buffer[i] = (char)('a' + (x >> 16) % alphabet);
+        }
+        if (!test_aven_str_find_check(str, needle)) {
+            return (AvenTestResult){
+                .error = 1,
+                .message = aven_str_fmt(
+                    &arena,
+                    "wrong result finding \"%.*s\" in \"%.*s\"",
+                    (int)needle.len,
+                    needle.ptr,
+                    (int)str.len,
+                    str.ptr
+                ).ptr,
+            };
+        }
+    }
+
+    // Needles that defeat candidate filtering, so the search falls back to
+    // Two-Way, with and without a match near either end
+    size_t len = 20000;
+    AvenStr str = { .len = len };
+    str.ptr = aven_arena_alloc(&arena, len, 1);
+    memset(str.ptr, 'a', len);
+    char needle_buffer[64];
+    memset(needle_buffer, 'a', sizeof(needle_buffer));
+    needle_buffer[sizeof(needle_buffer) / 2] = 'b';
+    AvenStr needles[] = {
+        { .ptr = needle_buffer, .len = sizeof(needle_buffer) },
+        { .ptr = needle_buffer, .len = sizeof(needle_buffer) / 2 + 1 },
+        { .ptr = needle_buffer + sizeof(needle_buffer) / 2, .len = 20 },
+    };
+    size_t positions[] = { len, 3, len / 2, len - 70 };
+    for (size_t i = 0; i < countof(needles); i += 1) {
+        for (size_t j = 0; j < countof(positions); j += 1) {
+            if (positions[j] < len) {
+                str.ptr[positions[j]] = 'b';
+            }
+            bool correct = test_aven_str_find_check(str, needles[i]);
+            if (positions[j] < len) {
+                str.ptr[positions[j]] = 'a';
+            }
+            if (!correct) {
+                return (AvenTestResult){
+                    .error = 2,
+                    .message = "wrong result for a periodic haystack",
+                };
+            }
+        }
+    }
+
+    if (
+        !aven_str_starts_with(aven_str("src/aven.c"), aven_str("src/")) or
+        aven_str_starts_with(aven_str("src"), aven_str("src/")) or
+        !aven_str_ends_with(aven_str("src/aven.c"), aven_str(".c")) or
+        aven_str_ends_with(aven_str("src/aven.h"), aven_str(".c"))
+    ) {
+        return (AvenTestResult){
+            .error = 3,
+            .message = "aven_str_starts_with or aven_str_ends_with wrong",
+        };
+    }
+
+    return (AvenTestResult){ 0 };
+}
+
+AvenTestResult test_aven_str_rope(AvenArena arena, void *args) {
+    (void)args;
+
+    // More pieces than a chunk or a single writev call holds
+    AvenStrRope rope = { 0 };
+    size_t npieces = 1000;
+    AvenStr *pieces = aven_arena_create_array(AvenStr, &arena, npieces);
+    for (size_t i = 0; i < npieces; i += 1) {
+        pieces[i] = aven_str_fmt(&arena, "%zu", i * 7919);
+    }
+    AvenStrSlice piece_slice = { .ptr = pieces, .len = npieces };
+    aven_str_rope_push(&rope, aven_str("["), &arena);
+    aven_str_rope_push_join(&rope, piece_slice, aven_str(", "), &arena);
+    aven_str_rope_push(&rope, aven_str(""), &arena);
+    aven_str_rope_push(&rope, aven_str("]"), &arena);
+
+    AvenStrBuilder builder = { 0 };
+    aven_str_builder_push_char(&builder, '[', &arena);
+    for (size_t i = 0; i < npieces; i += 1) {
+        if (i > 0) {
+            aven_str_builder_push(&builder, aven_str(", "), &arena);
+        }
+        aven_str_builder_push(&builder, pieces[i], &arena);
+    }
+    aven_str_builder_push_char(&builder, ']', &arena);
+    AvenStr expected = aven_str_builder_finish(&builder, &arena);
+
+    AvenStr flat = aven_str_rope_flatten(&rope, &arena);
+    if (
+        rope.len != expected.len or
+        !aven_str_compare(flat, expected) or
+        flat.ptr[flat.len] != 0
+    ) {
+        return (AvenTestResult){
+            .error = 1,
+            .message = "aven_str_rope_flatten wrong contents",
+        };
+    }
+
+    FILE *file = tmpfile();
+    if (file == NULL) {
+        return (AvenTestResult){
+            .error = 2,
+            .message = "tmpfile failed",
+        };
+    }
+    int error = aven_str_rope_write(&rope, fileno(file));
+    AvenStr written = { .len = expected.len };
+    written.ptr = aven_arena_alloc(&arena, written.len + 1, 1);
+    fseek(file, 0, SEEK_SET);
+    size_t read_len = fread(written.ptr, 1, written.len + 1, file);
+    fclose(file);
+
+    if (
+        error != 0 or
+        read_len != expected.len or
+        !aven_str_compare(written, expected)
+    ) {
+        return (AvenTestResult){
+            .error = 3,
+            .message = "aven_str_rope_write wrong contents",
+        };
+    }
+
+    return (AvenTestResult){ 0 };
+}
+
+int test_str(AvenArena arena) {
+    AvenTestCase tcase_data[] = {
+        {
+            .desc = "aven_str primitives match byte at a time results",
+            .fn = test_aven_str_primitives,
+        },
+        {
+            .desc = "aven_str_split and aven_str_split_view",
+            .fn = test_aven_str_split,
+        },
+        {
+            .desc = "aven_str_tokenizer lazily yields views",
+            .fn = test_aven_str_tokenizer,
+        },
+        {
+            .desc = "aven_str_intern canonicalizes strings",
+            .fn = test_aven_str_intern,
+        },
+        {
+            .desc = "aven_str_map insert, get, remove, and iterate",
+            .fn = test_aven_str_map,
+        },
+        {
+            .desc = "aven_str_builder grows in place",
+            .fn = test_aven_str_builder,
+        },
+        {
+            .desc = "aven_str_fmt matches snprintf",
+            .fn = test_aven_str_fmt,
+        },
+        {
+            .desc = "aven_str_utf8_valid matches a reference validator",
+            .fn = test_aven_str_utf8_valid,
+        },
+        {
+            .desc = "aven_str_utf8_next and aven_str_utf8_truncate",
+            .fn = test_aven_str_utf8_next,
+        },
+        {
+            .desc = "aven_str_find and aven_str_find_last match a naive search",
+            .fn = test_aven_str_find,
+        },
+        {
+            .desc = "aven_str_rope flattens and writes all pieces",
+            .fn = test_aven_str_rope,
+        },
+    };
+    AvenTestCaseSlice tcases = {
+        .ptr = tcase_data,
+        .len = countof(tcase_data),
+    };
+
+    aven_test(tcases, __FILE__, arena);
+
+    return 0;
+}
@@ -0,0 +1,80 @@
+// Built as its own translation unit and linked against the library object,
+// so only the declarations and their attributes are visible here, as in
+// client code, with glibc's buffer overflow checks enabled when optimizing
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+    #define _POSIX_C_SOURCE 200809L
+#endif
+#if defined(__OPTIMIZE__) && !defined(_FORTIFY_SOURCE)
+    #define _FORTIFY_SOURCE 2
+#endif
+
+#include <aven.h>
+#include <aven/arena.h>
+#include <aven/test.h>
+
+#include <stdlib.h>
+#include <string.h>
+
+#define ARENA_SIZE (4096 * 16)
+
+AvenTestResult test_fortify_arena_resize(AvenArena arena, void *args) {
+    (void)args;
+
+    // Writing past the original size must not look like an overflow
+    unsigned char *mem = aven_arena_alloc(&arena, 8, 1);
+    if (!aven_arena_resize(&arena, mem, 8, 64)) {
+        return (AvenTestResult){
+            .error = 1,
+            .message = "aven_arena_resize failed",
+        };
+    }
+    memset(mem, 0x5a, 64);
+
+    unsigned char *grown = aven_arena_realloc(&arena, mem, 64, 256, 1);
+    memset(grown + 64, 0xa5, 192);
+    if (grown[0] != 0x5a or grown[63] != 0x5a or grown[255] != 0xa5) {
+        return (AvenTestResult){
+            .error = 2,
+            .message = "grown allocation lost its contents",
+        };
+    }
+
+    return (AvenTestResult){ 0 };
+}
+
+AvenTestResult test_fortify_dyn_slice(AvenArena arena, void *args) {
+    (void)args;
+
+    DynSlice(uint64_t) nums = { 0 };
+    for (uint64_t i = 0; i < 100; i += 1) {
+        dyn_slice_push(uint64_t, nums, i, &arena);
+    }
+    memset(nums.ptr, 0, nums.len * sizeof(*nums.ptr));
+
+    return (AvenTestResult){ 0 };
+}
+
+int main(void) {
+    void *mem = malloc(ARENA_SIZE);
+    AvenArena arena = aven_arena_init(mem, ARENA_SIZE);
+
+    AvenTestCase tcase_data[] = {
+        {
+            .desc = "aven_arena_resize growth is writable",
+            .fn = test_fortify_arena_resize,
+        },
+        {
+            .desc = "dyn_slice_push growth is writable",
+            .fn = test_fortify_dyn_slice,
+        },
+    };
+    AvenTestCaseSlice tcases = {
+        .ptr = tcase_data,
+        .len = countof(tcase_data),
+    };
+
+    aven_test(tcases, __FILE__, arena);
+
+    free(mem);
+    return 0;
+}